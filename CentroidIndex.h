@@ -0,0 +1,191 @@
+/**
+* Centroid decomposition index over a flat tree structure.
+*
+* Dan Israel Malta
+**/
+#pragma once
+#include <vector>
+#include <set>
+#include <limits>
+#include <assert.h>
+
+/**
+* \brief centroid decomposition of a tree, supporting nearest marked node queries.
+*        each node has at most O(log(n)) centroid ancestors; for each of them the distance to the node is stored,
+*        and each centroid holds the set of marked nodes in its component ordered by their distance to it.
+*        i.e. - mark/unmark/nearestMarked are O(log(n)^2) operations, index is built in O(n * log(n)).
+*        index is built from a tree structure snapshot, and should be rebuilt if tree structure is modified.
+**/
+class CentroidIndex {
+
+    // properties
+    private:
+        std::vector<std::size_t> m_levels;                               // amount of centroid ancestors of each node (including itself)
+        std::vector<std::vector<std::size_t>> m_centroid;                // m_centroid[l][i] - centroid ancestor of node 'i' at decomposition level 'l'
+        std::vector<std::vector<std::size_t>> m_distance;                // m_distance[l][i] - distance between node 'i' and m_centroid[l][i]
+        std::vector<std::set<std::pair<std::size_t, std::size_t>>> m_marked; // per centroid - {distance, node} of marked nodes in its component
+        std::vector<bool> m_is_marked;                                   // is node marked?
+
+    // constructor
+    public:
+
+        /**
+        * \brief build centroid decomposition of a given tree
+        *
+        * @param {TREE, in} tree (an object with 'size' and 'getParentIndex' methods, such as FlatTree)
+        **/
+        template<class TREE> explicit CentroidIndex(TREE& xi_tree) {
+            const std::size_t len{ xi_tree.size() };
+            if (len == 0) return;
+
+            // undirected adjacency
+            std::vector<std::size_t> parent(len), offset(len + 1, 0), children(len - 1);
+            for (std::size_t i{ 1 }; i < len; ++i) {
+                parent[i] = xi_tree.getParentIndex(i);
+                ++offset[parent[i] + 1];
+            }
+            for (std::size_t i{}; i < len; ++i) {
+                offset[i + 1] += offset[i];
+            }
+            std::vector<std::size_t> cursor(offset.begin(), offset.end() - 1);
+            for (std::size_t i{ 1 }; i < len; ++i) {
+                children[cursor[parent[i]]++] = i;
+            }
+            const auto forEachNeighbour = [&parent, &offset, &children](const std::size_t v, auto&& f) {
+                if (v != 0) f(parent[v]);
+                for (std::size_t k{ offset[v] }; k < offset[v + 1]; ++k) f(children[k]);
+            };
+
+            // decompose
+            m_levels.assign(len, 0);
+            m_marked.resize(len);
+            m_is_marked.assign(len, false);
+            std::vector<bool> removed(len, false);
+            std::vector<std::size_t> from(len), subtree(len), dist(len), component;
+            std::vector<std::pair<std::size_t, std::size_t>> pending{ {0, 0} };  // {component node, decomposition level}
+            component.reserve(len);
+
+            while (!pending.empty()) {
+                const auto [start, level] = pending.back();
+                pending.pop_back();
+
+                // collect component (breadth first)
+                component.clear();
+                component.emplace_back(start);
+                from[start] = start;
+                for (std::size_t i{}; i < component.size(); ++i) {
+                    const std::size_t v{ component[i] };
+                    forEachNeighbour(v, [&](const std::size_t u) {
+                        if (removed[u] || (u == from[v])) return;
+                        from[u] = v;
+                        component.emplace_back(u);
+                    });
+                }
+
+                // sub-component sizes (reverse breadth first order)
+                for (std::size_t v : component) subtree[v] = 1;
+                for (std::size_t i{ component.size() - 1 }; i > 0; --i) {
+                    subtree[from[component[i]]] += subtree[component[i]];
+                }
+
+                // centroid - walk towards the heavy sub-component while it holds more than half of the nodes
+                const std::size_t total{ component.size() };
+                std::size_t centroid{ start };
+                for (bool moved{ true }; moved;) {
+                    moved = false;
+                    forEachNeighbour(centroid, [&](const std::size_t u) {
+                        if (moved || removed[u] || (u == from[centroid]) || (2 * subtree[u] <= total)) return;
+                        centroid = u;
+                        moved = true;
+                    });
+                }
+
+                // distance of every component node from centroid
+                if (m_centroid.size() <= level) {
+                    m_centroid.emplace_back(len, 0);
+                    m_distance.emplace_back(len, 0);
+                }
+                component.clear();
+                component.emplace_back(centroid);
+                from[centroid] = centroid;
+                dist[centroid] = 0;
+                for (std::size_t i{}; i < component.size(); ++i) {
+                    const std::size_t v{ component[i] };
+                    m_centroid[level][v] = centroid;
+                    m_distance[level][v] = dist[v];
+                    m_levels[v] = level + 1;
+                    forEachNeighbour(v, [&](const std::size_t u) {
+                        if (removed[u] || (u == from[v])) return;
+                        from[u] = v;
+                        dist[u] = dist[v] + 1;
+                        component.emplace_back(u);
+                    });
+                }
+
+                // remove centroid and decompose remaining sub-components
+                removed[centroid] = true;
+                forEachNeighbour(centroid, [&](const std::size_t u) {
+                    if (!removed[u]) pending.emplace_back(u, level + 1);
+                });
+            }
+        }
+
+    // marking
+    public:
+
+        // mark a node (given by its index)
+        void mark(const std::size_t xi_index) {
+            assert(xi_index < m_levels.size() && " node index is invalid");
+            if (m_is_marked[xi_index]) return;
+            m_is_marked[xi_index] = true;
+
+            for (std::size_t l{}; l < m_levels[xi_index]; ++l) {
+                m_marked[m_centroid[l][xi_index]].emplace(m_distance[l][xi_index], xi_index);
+            }
+        }
+
+        // unmark a node (given by its index)
+        void unmark(const std::size_t xi_index) {
+            assert(xi_index < m_levels.size() && " node index is invalid");
+            if (!m_is_marked[xi_index]) return;
+            m_is_marked[xi_index] = false;
+
+            for (std::size_t l{}; l < m_levels[xi_index]; ++l) {
+                m_marked[m_centroid[l][xi_index]].erase({ m_distance[l][xi_index], xi_index });
+            }
+        }
+
+        // is node (given by its index) marked?
+        bool isMarked(const std::size_t xi_index) const {
+            assert(xi_index < m_levels.size() && " node index is invalid");
+            return m_is_marked[xi_index];
+        }
+
+        /**
+        * \brief find the marked node closest (in tree distance) to a given node (given by its index)
+        *
+        * @param {size_t, in}  node index
+        * @param {size_t, out} index of closest marked node
+        * @param {size_t, out} distance between node and closest marked node
+        * @param {bool,   out} true if a marked node exists, false otherwise
+        **/
+        bool nearestMarked(const std::size_t xi_index, std::size_t& xo_node, std::size_t& xo_distance) const {
+            assert(xi_index < m_levels.size() && " node index is invalid");
+
+            bool xo_output{ false };
+            xo_distance = std::numeric_limits<std::size_t>::max();
+            for (std::size_t l{}; l < m_levels[xi_index]; ++l) {
+                const auto& marked = m_marked[m_centroid[l][xi_index]];
+                if (marked.empty()) continue;
+
+                const std::size_t d{ m_distance[l][xi_index] + marked.begin()->first };
+                if (d < xo_distance) {
+                    xo_distance = d;
+                    xo_node     = marked.begin()->second;
+                    xo_output   = true;
+                }
+            }
+
+            return xo_output;
+        }
+};
@@ -0,0 +1,803 @@
+/**
+* External memory (out of core) bulk algorithms over flat tree files.
+*
+* Dan Israel Malta
+**/
+#pragma once
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include "FlatTreeIO.h"
+
+namespace ExternalTreeDetail {
+
+    // positional read/write of an entire buffer
+    inline bool preadAll(const int xi_fd, void* xo_buffer, std::size_t xi_length, std::uint64_t xi_offset) noexcept {
+        char* buffer{ static_cast<char*>(xo_buffer) };
+        while (xi_length > 0) {
+            const ssize_t count{ ::pread(xi_fd, buffer, xi_length, static_cast<off_t>(xi_offset)) };
+            if (count <= 0) return false;
+            buffer    += count;
+            xi_offset += static_cast<std::uint64_t>(count);
+            xi_length -= static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+    inline bool pwriteAll(const int xi_fd, const void* xi_buffer, std::size_t xi_length, std::uint64_t xi_offset) noexcept {
+        const char* buffer{ static_cast<const char*>(xi_buffer) };
+        while (xi_length > 0) {
+            const ssize_t count{ ::pwrite(xi_fd, buffer, xi_length, static_cast<off_t>(xi_offset)) };
+            if (count <= 0) return false;
+            buffer    += count;
+            xi_offset += static_cast<std::uint64_t>(count);
+            xi_length -= static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+
+    // amount of records of a given size which fit in a given amount of bytes (at least 16)
+    template<typename R> inline constexpr std::size_t recordsIn(const std::size_t xi_bytes) noexcept {
+        return std::max<std::size_t>(xi_bytes / sizeof(R), 16);
+    }
+
+    /**
+    * \brief an unlinked temporary file (removed once closed)
+    **/
+    class TemporaryFile {
+
+        // properties
+        private:
+            int m_fd{ -1 };             // file descriptor
+            std::uint64_t m_length{};   // amount of bytes allocated (see 'reserve')
+
+        // constructor
+        public:
+
+            explicit TemporaryFile(const std::string& xi_directory) {
+                std::string path{ xi_directory + "/flat_tree_external_XXXXXX" };
+                m_fd = ::mkstemp(path.data());
+                if (m_fd >= 0) ::unlink(path.c_str());
+            }
+
+            ~TemporaryFile() {
+                if (m_fd >= 0) ::close(m_fd);
+            }
+
+            TemporaryFile(const TemporaryFile&)            = delete;
+            TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+        // queries
+        public:
+
+            inline bool valid() const noexcept { return m_fd >= 0; }
+            inline int  fd()    const noexcept { return m_fd; }
+
+            // reserve a region of a given length at file end, return its offset
+            inline std::uint64_t reserve(const std::uint64_t xi_length) noexcept {
+                const std::uint64_t offset{ m_length };
+                m_length += xi_length;
+                return offset;
+            }
+
+            // return the storage of a region which is no longer read to the file system (best effort, file length is kept)
+            inline void release([[maybe_unused]] const std::uint64_t xi_offset, [[maybe_unused]] const std::uint64_t xi_length) noexcept {
+#if defined(FALLOC_FL_PUNCH_HOLE) && defined(FALLOC_FL_KEEP_SIZE)
+                if (xi_length > 0) ::fallocate(m_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(xi_offset), static_cast<off_t>(xi_length));
+#endif
+            }
+
+            // discard all regions (none of them is read anymore), so file space is reused from its start
+            inline bool clear() noexcept {
+                m_length = 0;
+                return ::ftruncate(m_fd, 0) == 0;
+            }
+    };
+
+    /**
+    * \brief buffered reader of fixed size records stored contiguously in a file region, either forward or backward
+    *
+    * @param {R, in} record type (trivially copyable)
+    **/
+    template<typename R> class RecordReader {
+        static_assert(std::is_trivially_copyable_v<R>, "record type must be trivially copyable.");
+
+        // properties
+        private:
+            int m_fd{ -1 };             // file descriptor
+            std::uint64_t m_offset{};   // region offset
+            std::size_t m_count{};      // amount of records in region
+            std::size_t m_consumed{};   // amount of records read from region
+            bool m_reverse{ false };    // read backward?
+            bool m_failed{ false };     // did a read fail?
+            std::vector<R> m_buffer;    // read buffer
+            std::size_t m_position{};   // next record position in buffer
+            std::size_t m_filled{};     // amount of records in buffer
+
+        // constructor
+        public:
+
+            RecordReader() = default;
+            RecordReader(const int xi_fd, const std::uint64_t xi_offset, const std::size_t xi_count, const std::size_t xi_buffer_records, const bool xi_reverse = false) :
+                m_fd(xi_fd), m_offset(xi_offset), m_count(xi_count), m_reverse(xi_reverse), m_buffer(std::min(std::max<std::size_t>(xi_buffer_records, 1), std::max<std::size_t>(xi_count, 1))) {}
+
+        // operations
+        public:
+
+            // read next record, return false if region is exhausted (or read failed)
+            bool next(R& xo_record) {
+                if ((m_position == m_filled) && !fill()) return false;
+                xo_record = m_buffer[m_position++];
+                return true;
+            }
+
+            inline bool failed() const noexcept { return m_failed; }
+
+        // internal methods
+        private:
+
+            bool fill() {
+                const std::size_t remaining{ m_count - m_consumed };
+                if (remaining == 0) return false;
+
+                const std::size_t amount{ std::min(remaining, m_buffer.size()) },
+                                  first{ m_reverse ? (remaining - amount) : m_consumed };
+                if (!preadAll(m_fd, m_buffer.data(), amount * sizeof(R), m_offset + first * sizeof(R))) {
+                    m_failed = true;
+                    return false;
+                }
+                if (m_reverse) std::reverse(m_buffer.begin(), m_buffer.begin() + amount);
+
+                m_consumed += amount;
+                m_position  = 0;
+                m_filled    = amount;
+                return true;
+            }
+    };
+
+    /**
+    * \brief buffered writer of fixed size records into a file region, either forward or backward (last record first)
+    *
+    * @param {R, in} record type (trivially copyable)
+    **/
+    template<typename R> class RecordWriter {
+        static_assert(std::is_trivially_copyable_v<R>, "record type must be trivially copyable.");
+
+        // properties
+        private:
+            int m_fd{ -1 };             // file descriptor
+            std::uint64_t m_offset{};   // region offset
+            std::size_t m_count{};      // amount of records in region
+            std::size_t m_written{};    // amount of records flushed to region
+            bool m_reverse{ false };    // write backward?
+            bool m_failed{ false };     // did a write fail?
+            std::vector<R> m_buffer;    // write buffer
+            std::size_t m_filled{};     // amount of records in buffer
+
+        // constructor
+        public:
+
+            RecordWriter(const int xi_fd, const std::uint64_t xi_offset, const std::size_t xi_count, const std::size_t xi_buffer_records, const bool xi_reverse = false) :
+                m_fd(xi_fd), m_offset(xi_offset), m_count(xi_count), m_reverse(xi_reverse), m_buffer(std::min(std::max<std::size_t>(xi_buffer_records, 1), std::max<std::size_t>(xi_count, 1))) {}
+
+        // operations
+        public:
+
+            // write a record
+            void push(const R& xi_record) {
+                assert(m_written + m_filled < m_count && " record writer region overflow.");
+                m_buffer[m_filled++] = xi_record;
+                if (m_filled == m_buffer.size()) flush();
+            }
+
+            // flush buffered records, return false if any write failed
+            bool flush() {
+                if ((m_filled > 0) && !m_failed) {
+                    if (m_reverse) std::reverse(m_buffer.begin(), m_buffer.begin() + m_filled);
+                    const std::size_t first{ m_reverse ? (m_count - m_written - m_filled) : m_written };
+                    m_failed = !pwriteAll(m_fd, m_buffer.data(), m_filled * sizeof(R), m_offset + first * sizeof(R));
+                }
+                m_written += m_filled;
+                m_filled   = 0;
+                return !m_failed;
+            }
+    };
+
+    // a sorted run of records in a file
+    struct Run {
+        std::uint64_t offset;   // run offset in file
+        std::size_t count;      // amount of records in run
+    };
+
+    /**
+    * \brief k-way merge of sorted runs (a min heap of run cursors)
+    *
+    * @param {R,    in} record type
+    * @param {LESS, in} record order
+    **/
+    template<typename R, class LESS> class RunMerge {
+
+        // properties
+        private:
+            std::vector<RecordReader<R>> m_cursors; // run cursors
+            std::vector<R> m_heads;                 // next record of each cursor
+            std::vector<std::size_t> m_heap;        // cursors with remaining records, ordered by their head
+            std::size_t m_remaining{};              // amount of records not yet popped
+            LESS m_less;                            // record order
+            bool m_failed{ false };                 // did a read fail?
+
+        // operations
+        public:
+
+            // add a run to merge
+            void add(const int xi_fd, const Run& xi_run, const std::size_t xi_buffer_records) {
+                if (xi_run.count == 0) return;
+                m_cursors.emplace_back(xi_fd, xi_run.offset, xi_run.count, xi_buffer_records);
+                m_heads.emplace_back();
+                const std::size_t k{ m_cursors.size() - 1 };
+                if (!m_cursors[k].next(m_heads[k])) {
+                    m_failed = true;
+                    return;
+                }
+                m_heap.emplace_back(k);
+                std::push_heap(m_heap.begin(), m_heap.end(), [this](const std::size_t a, const std::size_t b) { return m_less(m_heads[b], m_heads[a]); });
+                m_remaining += xi_run.count;
+            }
+
+            inline bool empty()            const noexcept { return m_heap.empty();    }
+            inline bool failed()           const noexcept { return m_failed;          }
+            inline std::size_t cursors()   const noexcept { return m_heap.size();     }
+            inline std::size_t remaining() const noexcept { return m_remaining;       }
+            inline const R& top()          const noexcept { return m_heads[m_heap.front()]; }
+
+            // remove smallest record
+            void pop() {
+                const auto greater = [this](const std::size_t a, const std::size_t b) { return m_less(m_heads[b], m_heads[a]); };
+                std::pop_heap(m_heap.begin(), m_heap.end(), greater);
+                const std::size_t k{ m_heap.back() };
+                --m_remaining;
+                if (m_cursors[k].next(m_heads[k])) {
+                    std::push_heap(m_heap.begin(), m_heap.end(), greater);
+                } else {
+                    m_failed = m_failed || m_cursors[k].failed();
+                    m_heap.pop_back();
+                }
+            }
+    };
+
+    /**
+    * \brief external merge sort - records are collected in memory sized runs, which are sorted and spilled into a temporary file,
+    *        and then merged (in several passes if there are too many runs for the memory budget).
+    *
+    * @param {R,    in} record type
+    * @param {LESS, in} record order
+    **/
+    template<typename R, class LESS> class ExternalSorter {
+
+        // properties
+        private:
+            TemporaryFile m_file;               // runs file
+            std::size_t m_memory;               // amount of records held in memory
+            std::vector<R> m_buffer;            // current run (or all records, if none were spilled)
+            std::size_t m_position{};           // next record in buffer (if none were spilled)
+            std::vector<Run> m_runs;            // spilled runs
+            RunMerge<R, LESS> m_merge;          // final merge
+            bool m_failed{ false };             // did an I/O operation fail?
+
+        // constructor
+        public:
+
+            // @param {string, in} directory of temporary files
+            // @param {size_t, in} memory budget [bytes]
+            ExternalSorter(const std::string& xi_directory, const std::size_t xi_memory) : m_file(xi_directory), m_memory(recordsIn<R>(xi_memory)) {
+                m_failed = !m_file.valid();
+                m_buffer.reserve(m_memory);
+            }
+
+        // operations
+        public:
+
+            // add a record
+            void push(const R& xi_record) {
+                m_buffer.emplace_back(xi_record);
+                if (m_buffer.size() == m_memory) spill();
+            }
+
+            // sort added records, return false if an I/O operation failed
+            bool sort() {
+                if (m_runs.empty()) {
+                    std::sort(m_buffer.begin(), m_buffer.end(), LESS{});
+                    return !m_failed;
+                }
+                if (!m_buffer.empty()) spill();
+                std::vector<R>().swap(m_buffer);
+
+                // merge passes until all runs can be merged at once
+                const std::size_t fan_in{ std::max<std::size_t>(m_memory / 1024, 2) },
+                                  cursor_records{ std::max<std::size_t>(m_memory / (fan_in + 1), 1) };
+                while (!m_failed && (m_runs.size() > fan_in)) {
+                    std::vector<Run> runs;
+                    for (std::size_t first{}; first < m_runs.size(); first += fan_in) {
+                        RunMerge<R, LESS> merge;
+                        for (std::size_t k{ first }; k < std::min(first + fan_in, m_runs.size()); ++k) {
+                            merge.add(m_file.fd(), m_runs[k], cursor_records);
+                        }
+                        runs.emplace_back(drain(merge, cursor_records));
+                    }
+                    m_runs = std::move(runs);
+                }
+
+                for (const Run& run : m_runs) {
+                    m_merge.add(m_file.fd(), run, cursor_records);
+                }
+                return !m_failed && !m_merge.failed();
+            }
+
+            // return next record in sorted order (false once all were read)
+            bool next(R& xo_record) {
+                if (m_runs.empty()) {
+                    if (m_position == m_buffer.size()) return false;
+                    xo_record = m_buffer[m_position++];
+                    return true;
+                }
+
+                if (m_merge.empty()) return false;
+                xo_record = m_merge.top();
+                m_merge.pop();
+                return true;
+            }
+
+            inline bool failed() const noexcept { return m_failed || m_merge.failed(); }
+
+        // internal methods
+        private:
+
+            // write remaining records of a merge into a new run
+            Run drain(RunMerge<R, LESS>& xio_merge, const std::size_t xi_buffer_records) {
+                const Run run{ m_file.reserve(xio_merge.remaining() * sizeof(R)), xio_merge.remaining() };
+                RecordWriter<R> writer(m_file.fd(), run.offset, run.count, xi_buffer_records);
+                while (!xio_merge.empty()) {
+                    writer.push(xio_merge.top());
+                    xio_merge.pop();
+                }
+                m_failed = m_failed || !writer.flush() || xio_merge.failed();
+                return run;
+            }
+
+            // sort current run and spill it
+            void spill() {
+                std::sort(m_buffer.begin(), m_buffer.end(), LESS{});
+                const Run run{ m_file.reserve(m_buffer.size() * sizeof(R)), m_buffer.size() };
+                m_failed = m_failed || !pwriteAll(m_file.fd(), m_buffer.data(), m_buffer.size() * sizeof(R), run.offset);
+                m_runs.emplace_back(run);
+                m_buffer.clear();
+            }
+    };
+
+    /**
+    * \brief external priority queue for time forward processing, i.e. - records are popped in ascending order,
+    *        and a pushed record is never smaller than the last popped record.
+    *        records are held in a memory heap (sized by memory budget), which is spilled as a sorted run once full.
+    *        runs are merged on the fly and organized in levels: spilled runs are at level 0, and once a level holds too many runs,
+    *        their remaining records are merged into a single run at the next level. so a record is rewritten at most once per level
+    *        (i.e. - logarithmically many times), and file space of merged (or consumed) runs is released.
+    *
+    * @param {R,    in} record type
+    * @param {LESS, in} record order
+    **/
+    template<typename R, class LESS> class ExternalPriorityQueue {
+
+        // properties
+        private:
+            static constexpr std::size_t runs_per_level{ 16 };  // above this amount of runs in a level, level runs are merged into next level
+            static constexpr std::size_t budgeted_levels{ 4 };  // amount of levels whose cursors are accounted for in memory budget
+
+            // runs of a level, merged on the fly
+            struct Level {
+                RunMerge<R, LESS> merge;    // level runs merge
+                std::vector<Run> runs;      // level runs (released once merged or consumed)
+            };
+
+            TemporaryFile m_file;                               // runs file
+            std::size_t m_capacity;                             // amount of records held in memory heap
+            std::size_t m_cursor_records;                       // amount of records buffered per run cursor
+            std::vector<R> m_heap;                              // memory heap (min heap)
+            std::vector<Level> m_levels;                        // spilled runs, by level
+            LESS m_less;                                        // record order
+            bool m_failed{ false };                             // did an I/O operation fail?
+
+        // constructor
+        public:
+
+            // @param {string, in} directory of temporary files
+            // @param {size_t, in} memory budget [bytes] (half is used by memory heap, and half by run cursors)
+            ExternalPriorityQueue(const std::string& xi_directory, const std::size_t xi_memory) :
+                m_file(xi_directory), m_capacity(recordsIn<R>(xi_memory / 2)),
+                m_cursor_records(recordsIn<R>(xi_memory / (2 * (runs_per_level * budgeted_levels + 1)))) {
+                m_failed = !m_file.valid();
+            }
+
+        // operations
+        public:
+
+            void push(const R& xi_record) {
+                if (m_heap.size() == m_capacity) spill();
+                m_heap.emplace_back(xi_record);
+                std::push_heap(m_heap.begin(), m_heap.end(), greater());
+            }
+
+            inline bool empty() const noexcept { return m_heap.empty() && (smallestLevel() == m_levels.size()); }
+
+            // smallest record (queue must not be empty)
+            inline const R& top() const noexcept {
+                const std::size_t level{ smallestLevel() };
+                if (level == m_levels.size()) return m_heap.front();
+                const R& spilled{ m_levels[level].merge.top() };
+                return (m_heap.empty() || m_less(spilled, m_heap.front())) ? spilled : m_heap.front();
+            }
+
+            // remove smallest record (queue must not be empty)
+            void pop() {
+                const std::size_t level{ smallestLevel() };
+                if ((level < m_levels.size()) && (m_heap.empty() || m_less(m_levels[level].merge.top(), m_heap.front()))) {
+                    m_levels[level].merge.pop();
+                    if (m_levels[level].merge.empty()) releaseLevel(level);
+                } else {
+                    std::pop_heap(m_heap.begin(), m_heap.end(), greater());
+                    m_heap.pop_back();
+                }
+            }
+
+            inline bool failed() const noexcept {
+                return m_failed || std::any_of(m_levels.begin(), m_levels.end(), [](const Level& level) { return level.merge.failed(); });
+            }
+
+        // internal methods
+        private:
+
+            inline auto greater() const noexcept { return [this](const R& a, const R& b) { return m_less(b, a); }; }
+
+            // level holding smallest spilled record (amount of levels if none holds records)
+            inline std::size_t smallestLevel() const noexcept {
+                std::size_t smallest{ m_levels.size() };
+                for (std::size_t l{}; l < m_levels.size(); ++l) {
+                    if (m_levels[l].merge.empty()) continue;
+                    if ((smallest == m_levels.size()) || m_less(m_levels[l].merge.top(), m_levels[smallest].merge.top())) smallest = l;
+                }
+                return smallest;
+            }
+
+            // release file space of a level runs (once merged or consumed), file is reused from its start once no run is held
+            void releaseLevel(const std::size_t xi_level) {
+                for (const Run& run : m_levels[xi_level].runs) {
+                    m_file.release(run.offset, run.count * sizeof(R));
+                }
+                m_levels[xi_level] = Level{};
+                if (std::all_of(m_levels.begin(), m_levels.end(), [](const Level& level) { return level.runs.empty(); })) {
+                    m_levels.clear();
+                    m_failed = m_failed || !m_file.clear();
+                }
+            }
+
+            // add a run to a level, merging level runs into next level if there are too many of them
+            void addRun(const std::size_t xi_level, const Run& xi_run) {
+                if (xi_run.count == 0) return;
+                if (xi_level == m_levels.size()) m_levels.emplace_back();
+                m_levels[xi_level].merge.add(m_file.fd(), xi_run, m_cursor_records);
+                m_levels[xi_level].runs.emplace_back(xi_run);
+                if (m_levels[xi_level].merge.cursors() <= runs_per_level) return;
+
+                RunMerge<R, LESS>& merge{ m_levels[xi_level].merge };
+                const Run merged{ m_file.reserve(merge.remaining() * sizeof(R)), merge.remaining() };
+                RecordWriter<R> writer(m_file.fd(), merged.offset, merged.count, m_cursor_records);
+                while (!merge.empty()) {
+                    writer.push(merge.top());
+                    merge.pop();
+                }
+                m_failed = m_failed || !writer.flush() || merge.failed();
+                for (const Run& run : m_levels[xi_level].runs) {
+                    m_file.release(run.offset, run.count * sizeof(R));
+                }
+                m_levels[xi_level] = Level{};
+                addRun(xi_level + 1, merged);
+            }
+
+            // spill memory heap as a sorted run
+            void spill() {
+                std::sort(m_heap.begin(), m_heap.end(), m_less);
+                const Run run{ m_file.reserve(m_heap.size() * sizeof(R)), m_heap.size() };
+                m_failed = m_failed || !pwriteAll(m_file.fd(), m_heap.data(), m_heap.size() * sizeof(R), run.offset);
+                m_heap.clear();
+                addRun(0, run);
+            }
+    };
+
+    // a message sent to a node (given by its index) in time forward processing
+    template<typename A> struct Message {
+        std::uint64_t node;
+        A value;
+    };
+    struct MessageOrder {
+        template<typename A> bool operator()(const Message<A>& xi_a, const Message<A>& xi_b) const noexcept { return xi_a.node < xi_b.node; }
+    };
+
+    // a tree edge, along with child sub-tree size
+    struct Edge {
+        std::uint64_t parent;
+        std::uint64_t child;
+        std::uint64_t size;
+    };
+    struct EdgeOrder {
+        bool operator()(const Edge& xi_a, const Edge& xi_b) const noexcept {
+            return (xi_a.parent < xi_b.parent) || ((xi_a.parent == xi_b.parent) && (xi_a.child < xi_b.child));
+        }
+    };
+
+    // open a raw tree file and read its header
+    inline int openTree(const std::string& xi_path, FlatTreeIODetail::FileHeader& xo_header) {
+        const int fd{ ::open(xi_path.c_str(), O_RDONLY) };
+        if (fd < 0) return -1;
+        if (!preadAll(fd, &xo_header, sizeof(xo_header), 0) || (std::memcmp(xo_header.magic, FlatTreeIODetail::magic, sizeof(FlatTreeIODetail::magic)) != 0) ||
+            (xo_header.version != FlatTreeIODetail::raw_version) || (xo_header.size == 0)) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // create an output file of a given length
+    inline int createOutput(const std::string& xi_path, const std::uint64_t xi_length) {
+        const int fd{ ::open(xi_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) };
+        if ((fd >= 0) && (::ftruncate(fd, static_cast<off_t>(xi_length)) != 0)) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    /**
+    * \brief sort tree edges by parent (i.e. - first generation descendants of each node, in index order).
+    *        parent indices are scanned sequentially, along with sub-tree sizes (if given).
+    *        tree must be topologically ordered (parent index is smaller than node index).
+    **/
+    inline bool sortEdges(const int xi_tree_fd, const std::size_t xi_size, const int xi_sizes_fd, ExternalSorter<Edge, EdgeOrder>& xio_edges, const std::size_t xi_buffer_records) {
+        RecordReader<std::uint64_t> parents(xi_tree_fd, sizeof(FlatTreeIODetail::FileHeader), xi_size, xi_buffer_records);
+        RecordReader<std::uint64_t> sizes(xi_sizes_fd, 0, (xi_sizes_fd >= 0) ? xi_size : 0, xi_buffer_records);
+
+        for (std::uint64_t i{}; i < xi_size; ++i) {
+            std::uint64_t parent{},
+                          size{};
+            if (!parents.next(parent) || ((xi_sizes_fd >= 0) && !sizes.next(size))) return false;
+            if ((i == 0) ? (parent != 0) : (parent >= i)) return false;
+            if (i > 0) xio_edges.push(Edge{ parent, i, size });
+        }
+        return xio_edges.sort();
+    }
+
+    // sub-tree reduction by reverse time forward processing (nodes are processed from last to first, each sending its reduction to its parent)
+    template<typename A, class INIT, class COMBINE>
+    bool reduce(const int xi_tree_fd, const std::size_t xi_size, const int xi_output_fd, INIT&& xi_init, COMBINE&& xi_combine,
+                const std::string& xi_directory, const std::size_t xi_memory) {
+        const std::size_t buffer_records{ recordsIn<std::uint64_t>(xi_memory / 8) };
+        RecordReader<std::uint64_t> parents(xi_tree_fd, sizeof(FlatTreeIODetail::FileHeader), xi_size, buffer_records, true);
+        RecordWriter<A> output(xi_output_fd, 0, xi_size, recordsIn<A>(xi_memory / 8), true);
+        ExternalPriorityQueue<Message<A>, MessageOrder> messages(xi_directory, xi_memory / 2);
+
+        // messages are keyed by reversed parent index, so they are popped in descending parent order
+        for (std::size_t i{ xi_size }; i > 0; --i) {
+            const std::uint64_t node{ i - 1 },
+                                key{ xi_size - i };
+            std::uint64_t parent{};
+            if (!parents.next(parent) || ((node == 0) ? (parent != 0) : (parent >= node))) return false;
+
+            A value(xi_init(node));
+            while (!messages.empty() && (messages.top().node == key)) {
+                xi_combine(value, messages.top().value);
+                messages.pop();
+            }
+            output.push(value);
+            if (node > 0) messages.push(Message<A>{ xi_size - 1 - parent, value });
+        }
+
+        return output.flush() && !messages.failed() && !parents.failed();
+    }
+}
+
+namespace ExternalTree {
+
+    /**
+    * \brief compute the depth of every node of a tree stored in a (raw) tree file (see FlatTreeIO::save), using bounded memory.
+    *        tree edges are externally sorted by parent, and depths are then propagated by time forward processing:
+    *        nodes are scanned in index order, each receiving its depth from an external priority queue and sending its children theirs.
+    *        tree must be topologically ordered (parent index smaller than node index, i.e. - as laid out by 'sortChildren').
+    *
+    * @param {string, in}  tree file path
+    * @param {string, in}  output file path (node depths, uint64 per node in node order)
+    * @param {size_t, in}  memory budget [bytes]
+    * @param {string, in}  directory of temporary files
+    * @param {bool,   out} true if depths were computed, false otherwise
+    **/
+    inline bool computeDepth(const std::string& xi_tree_path, const std::string& xi_output_path,
+                             const std::size_t xi_memory = std::size_t{ 64 } << 20, const std::string& xi_directory = "/tmp") {
+        using namespace ExternalTreeDetail;
+        FlatTreeIODetail::FileHeader header{};
+        const int tree_fd{ openTree(xi_tree_path, header) };
+        if (tree_fd < 0) return false;
+        const std::size_t len{ header.size };
+
+        bool succeed{ false };
+        const int output_fd{ createOutput(xi_output_path, len * sizeof(std::uint64_t)) };
+        if (output_fd >= 0) {
+            ExternalSorter<Edge, EdgeOrder> edges(xi_directory, xi_memory / 4);
+            succeed = sortEdges(tree_fd, len, -1, edges, recordsIn<std::uint64_t>(xi_memory / 8));
+
+            RecordWriter<std::uint64_t> output(output_fd, 0, len, recordsIn<std::uint64_t>(xi_memory / 8));
+            ExternalPriorityQueue<Message<std::uint64_t>, MessageOrder> messages(xi_directory, xi_memory / 2);
+            Edge edge{};
+            bool has_edge{ succeed && edges.next(edge) };
+            for (std::uint64_t i{}; succeed && (i < len); ++i) {
+                std::uint64_t depth{};
+                if (i > 0) {
+                    succeed = !messages.empty() && (messages.top().node == i);
+                    if (!succeed) break;
+                    depth = messages.top().value;
+                    messages.pop();
+                }
+                output.push(depth);
+
+                for (; has_edge && (edge.parent == i); has_edge = edges.next(edge)) {
+                    messages.push(Message<std::uint64_t>{ edge.child, depth + 1 });
+                }
+            }
+            succeed = succeed && output.flush() && !edges.failed() && !messages.failed();
+            succeed = (::close(output_fd) == 0) && succeed;
+        }
+        ::close(tree_fd);
+
+        return succeed;
+    }
+
+    /**
+    * \brief reduce every sub-tree of a tree stored in a (raw) tree file (see FlatTreeIO::save), using bounded memory.
+    *        nodes are scanned from last to first (reverse time forward processing), each combining its own value with the
+    *        reductions received from its first generation descendants and sending the result to its parent.
+    *        tree must be topologically ordered (parent index smaller than node index).
+    *
+    * @param {T,        in}  tree node type
+    * @param {A,        in}  reduction type (trivially copyable)
+    * @param {string,   in}  tree file path
+    * @param {string,   in}  output file path (sub-tree reductions, one A per node in node order)
+    * @param {function, in}  node reduction initialization (const T& -> A)
+    * @param {function, in}  reduction combination (A& node reduction, const A& descendant reduction), should be associative and commutative
+    * @param {size_t,   in}  memory budget [bytes]
+    * @param {string,   in}  directory of temporary files
+    * @param {bool,     out} true if reductions were computed, false otherwise
+    **/
+    template<typename T, typename A, class INIT, class COMBINE>
+    bool reduceSubtrees(const std::string& xi_tree_path, const std::string& xi_output_path, INIT&& xi_init, COMBINE&& xi_combine,
+                        const std::size_t xi_memory = std::size_t{ 64 } << 20, const std::string& xi_directory = "/tmp") {
+        using namespace ExternalTreeDetail;
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<A>, "node and reduction types must be trivially copyable.");
+        FlatTreeIODetail::FileHeader header{};
+        const int tree_fd{ openTree(xi_tree_path, header) };
+        if (tree_fd < 0) return false;
+        const std::size_t len{ header.size };
+
+        bool succeed{ false };
+        const int output_fd{ (header.value_size == sizeof(T)) ? createOutput(xi_output_path, len * sizeof(A)) : -1 };
+        if (output_fd >= 0) {
+            RecordReader<T> values(tree_fd, sizeof(FlatTreeIODetail::FileHeader) + len * sizeof(std::uint64_t), len, recordsIn<T>(xi_memory / 8), true);
+            bool read_ok{ true };
+            succeed = reduce<A>(tree_fd, len, output_fd, [&values, &xi_init, &read_ok](const std::uint64_t) {
+                T value{};
+                read_ok = values.next(value) && read_ok;
+                return A(xi_init(static_cast<const T&>(value)));
+            }, std::forward<COMBINE>(xi_combine), xi_directory, xi_memory / 2);
+            succeed = succeed && read_ok && !values.failed();
+            succeed = (::close(output_fd) == 0) && succeed;
+        }
+        ::close(tree_fd);
+
+        return succeed;
+    }
+
+    /**
+    * \brief compute the sub-tree size (amount of nodes, including itself) of every node of a tree stored in a (raw) tree file,
+    *        using bounded memory (see 'reduceSubtrees'). tree must be topologically ordered (parent index smaller than node index).
+    *
+    * @param {string, in}  tree file path
+    * @param {string, in}  output file path (sub-tree sizes, uint64 per node in node order)
+    * @param {size_t, in}  memory budget [bytes]
+    * @param {string, in}  directory of temporary files
+    * @param {bool,   out} true if sizes were computed, false otherwise
+    **/
+    inline bool computeSubtreeSize(const std::string& xi_tree_path, const std::string& xi_output_path,
+                                   const std::size_t xi_memory = std::size_t{ 64 } << 20, const std::string& xi_directory = "/tmp") {
+        using namespace ExternalTreeDetail;
+        FlatTreeIODetail::FileHeader header{};
+        const int tree_fd{ openTree(xi_tree_path, header) };
+        if (tree_fd < 0) return false;
+        const std::size_t len{ header.size };
+
+        bool succeed{ false };
+        const int output_fd{ createOutput(xi_output_path, len * sizeof(std::uint64_t)) };
+        if (output_fd >= 0) {
+            succeed = reduce<std::uint64_t>(tree_fd, len, output_fd, [](const std::uint64_t) { return std::uint64_t{ 1 }; },
+                                            [](std::uint64_t& xio_size, const std::uint64_t xi_descendant) { xio_size += xi_descendant; },
+                                            xi_directory, xi_memory);
+            succeed = (::close(output_fd) == 0) && succeed;
+        }
+        ::close(tree_fd);
+
+        return succeed;
+    }
+
+    /**
+    * \brief compute the pre-order (depth first) position of every node of a tree stored in a (raw) tree file, using bounded memory.
+    *        first generation descendants are visited in index order. sub-tree sizes are computed first (see 'computeSubtreeSize'),
+    *        edges (with child sub-tree sizes) are externally sorted by parent, and positions are then propagated by time forward
+    *        processing: each node receives its position, and sends its k'th child position + 1 + sizes of its first k - 1 children.
+    *        tree must be topologically ordered (parent index smaller than node index).
+    *
+    * @param {string, in}  tree file path
+    * @param {string, in}  output file path (pre-order positions, uint64 per node in node order)
+    * @param {size_t, in}  memory budget [bytes]
+    * @param {string, in}  directory of temporary files
+    * @param {bool,   out} true if positions were computed, false otherwise
+    **/
+    inline bool computePreorder(const std::string& xi_tree_path, const std::string& xi_output_path,
+                                const std::size_t xi_memory = std::size_t{ 64 } << 20, const std::string& xi_directory = "/tmp") {
+        using namespace ExternalTreeDetail;
+        FlatTreeIODetail::FileHeader header{};
+        const int tree_fd{ openTree(xi_tree_path, header) };
+        if (tree_fd < 0) return false;
+        const std::size_t len{ header.size };
+
+        // sub-tree sizes
+        TemporaryFile sizes(xi_directory);
+        bool succeed{ sizes.valid() && (::ftruncate(sizes.fd(), static_cast<off_t>(len * sizeof(std::uint64_t))) == 0) };
+        succeed = succeed && reduce<std::uint64_t>(tree_fd, len, sizes.fd(), [](const std::uint64_t) { return std::uint64_t{ 1 }; },
+                                                   [](std::uint64_t& xio_size, const std::uint64_t xi_descendant) { xio_size += xi_descendant; },
+                                                   xi_directory, xi_memory);
+
+        const int output_fd{ succeed ? createOutput(xi_output_path, len * sizeof(std::uint64_t)) : -1 };
+        if (output_fd >= 0) {
+            ExternalSorter<Edge, EdgeOrder> edges(xi_directory, xi_memory / 4);
+            succeed = sortEdges(tree_fd, len, sizes.fd(), edges, recordsIn<std::uint64_t>(xi_memory / 8));
+
+            RecordWriter<std::uint64_t> output(output_fd, 0, len, recordsIn<std::uint64_t>(xi_memory / 8));
+            ExternalPriorityQueue<Message<std::uint64_t>, MessageOrder> messages(xi_directory, xi_memory / 2);
+            Edge edge{};
+            bool has_edge{ succeed && edges.next(edge) };
+            for (std::uint64_t i{}; succeed && (i < len); ++i) {
+                std::uint64_t position{};
+                if (i > 0) {
+                    succeed = !messages.empty() && (messages.top().node == i);
+                    if (!succeed) break;
+                    position = messages.top().value;
+                    messages.pop();
+                }
+                output.push(position);
+
+                std::uint64_t next{ position + 1 };
+                for (; has_edge && (edge.parent == i); has_edge = edges.next(edge)) {
+                    messages.push(Message<std::uint64_t>{ edge.child, next });
+                    next += edge.size;
+                }
+            }
+            succeed = succeed && output.flush() && !edges.failed() && !messages.failed();
+            succeed = (::close(output_fd) == 0) && succeed;
+        } else {
+            succeed = false;
+        }
+        ::close(tree_fd);
+
+        return succeed;
+    }
+}
@@ -12,6 +12,19 @@
 #include <execution>
 #include <algorithm>
 #include <memory>
+#include <numeric>
+#include <cstdint>
+#include <unordered_map>
+#include <functional>
+#include <limits>
+#include <cmath>
+
+// expected memory access pattern of a tree operation (see 'has_advise_method' and MappedFileAllocator)
+enum class AccessPattern {
+    Normal,     // no particular pattern
+    Sequential, // collections are scanned
+    Random      // collections are accessed at scattered positions
+};
 
 // type traits
 namespace {
@@ -40,8 +53,76 @@ namespace {
     template<typename T> struct is_vector<std::initializer_list<T>> : std::true_type {};
     template<typename T> struct is_vector<std::vector<T>>           : std::true_type {};
     template<typename T> inline constexpr bool is_vector_v = is_vector<T>::value;
+
+    // test if an object has a '+=' operator
+    template<typename T, typename = void> struct has_plus_assign_operator                                                                    : std::false_type {};
+    template<typename T>                  struct has_plus_assign_operator<T, std::void_t<decltype(std::declval<T&>() += std::declval<const T&>())>> : std::true_type {};
+    template<typename T> inline constexpr bool has_plus_assign_operator_v = has_plus_assign_operator<T>::value;
+
+    // test if an allocator has an 'advise' method (accepting memory access pattern hints)
+    template<typename T, typename = void> struct has_advise_method                                                                                                                       : std::false_type {};
+    template<typename T>                  struct has_advise_method<T, std::void_t<decltype(std::declval<const T&>().advise(std::declval<const void*>(), std::size_t{}, AccessPattern{}))>> : std::true_type  {};
+    template<typename T> inline constexpr bool has_advise_method_v = has_advise_method<T>::value;
+}
+
+namespace FlatTreeDetail {
+    // invoke a function on every index in [0, xi_len), processing contiguous chunks of indices concurrently once there are at least xi_parallel_from of them.
+    // notice that indices are handed over by value - parallel algorithms might hand trivially copyable elements over as copies, so indices are never deduced from element addresses.
+    template<class FUNC> void forEachIndex(const std::size_t xi_len, const std::size_t xi_parallel_from, FUNC&& xi_func) {
+        if (xi_len < xi_parallel_from) {
+            for (std::size_t i{}; i < xi_len; ++i) xi_func(i);
+            return;
+        }
+
+        constexpr std::size_t max_chunks{ 256 };
+        const std::size_t chunks{ std::min(max_chunks, (xi_len + xi_parallel_from - 1) / xi_parallel_from) },
+                          chunk_size{ (xi_len + chunks - 1) / chunks };
+        std::vector<std::size_t> chunk(chunks);
+        std::iota(chunk.begin(), chunk.end(), 0);
+        std::for_each(std::execution::par, chunk.begin(), chunk.end(), [xi_len, chunk_size, &xi_func](const std::size_t c) {
+            for (std::size_t i{ c * chunk_size }; i < std::min(xi_len, (c + 1) * chunk_size); ++i) xi_func(i);
+        });
+    }
 }
 
+// how nodes which do not satisfy a filter are handled (see FlatTree::filter)
+enum class FilterMode {
+    Prune,  // a node which does not satisfy the filter is removed along with its entire sub-tree
+    Lift    // a node which does not satisfy the filter is removed, its descendants which satisfy it are attached to their nearest kept ancestor
+};
+
+// how tree nodes are relocated when a tree is reordered (see FlatTree::reorder)
+enum class ReorderMode {
+    OutOfPlace, // nodes are moved (in parallel) into newly allocated collections
+    InPlace     // nodes are moved along permutation cycles, no additional node storage is allocated
+};
+
+// order in which nodes gathered by a traversal are visited (see FlatTree::Traverse)
+enum class GatherOrder {
+    Discovery,  // nodes are visited in the order they were gathered (first generation descendants, followed by each of their sub-trees, depth first; all nodes in index order for the root)
+    Sorted      // gathered indices are sorted before visiting, so nodes are visited in memory order
+};
+
+// which nodes a derived node attribute depends on (see FlatTree::registerAttribute)
+enum class AttributeDependency {
+    Ancestors,  // node attribute is derived from its value and its parent attribute (i.e. - inherited properties)
+    Descendants // node attribute is derived from its value and its first generation descendants attributes (i.e. - roll-ups)
+};
+
+// handle of a derived node attribute registered on a tree (see FlatTree::registerAttribute)
+template<typename A> struct AttributeHandle {
+    std::size_t id{};   // attribute position in tree attribute registry
+};
+
+// tree structural profile (see FlatTree::profile)
+struct TreeProfile {
+    std::vector<std::size_t> child_count;   // amount of first generation descendants of each node
+    std::vector<std::size_t> fan_out;       // fan_out[k] is the amount of nodes with k first generation descendants
+    std::vector<std::size_t> width;         // width[d] is the amount of nodes at depth d (i.e. - depth distribution)
+    std::size_t leaves{};                   // amount of nodes without descendants
+    std::size_t height{};                   // depth of deepest node (root depth is 0)
+};
+
 /**
 * \brief a general purpose flat tree data structure.
 *        tree is built such that each node can have only one parent.
@@ -62,6 +143,84 @@ class FlatTree {
         static constexpr std::size_t size_for_parallelization{ 2'000 }; // above this number of tree nodes, certain operations shall be parallelized
         std::vector<T, DataAllocator> m_data;                           // collection holding tree node values
         std::vector<std::size_t, IndexAllocator> m_parent_index;        // collection holding tree nodes parent index.
+        std::size_t m_structure_version{};                              // incremented whenever tree structure is modified
+
+        // structural index, lazily rebuilt (see 'updateStructureIndex') when tree structure was modified since it was last built
+        struct StructureIndex {
+            std::size_t version{ static_cast<std::size_t>(-1) }; // tree structure version this index was built for
+            std::vector<std::size_t> child_offset;               // first generation descendants of node 'i' are children[child_offset[i]] ... children[child_offset[i + 1] - 1]
+            std::vector<std::size_t> children;                   // first generation descendants, grouped by parent
+            std::vector<std::size_t> breadth_first;              // node indices in breadth first order
+            std::vector<std::size_t> depth;                      // node depth (root depth is 0)
+            std::vector<std::size_t> preorder;                   // node position in a depth first (pre-order) traversal
+            std::vector<std::size_t> subtree_size;               // amount of nodes in sub-tree rooted at node (including itself)
+            std::vector<std::size_t> jump;                       // skew-binary jump pointer (an ancestor of node) used for O(log(n)) ancestor queries
+            std::size_t height{};                                // depth of deepest node
+        } m_index;
+
+        // pending sub-tree update (see 'subtreeAdd'/'subtreeAssign')
+        struct LazyTag {
+            enum class Kind : std::uint8_t { None, Add, Assign } kind{ Kind::None };
+            T value{};  // value to add/assign
+        };
+
+        // pending sub-tree updates, held in a segment tree over nodes pre-order positions.
+        // tags are pushed down when an update partially covers a segment, so a segment tag is always newer than the tags of its sub-segments.
+        struct LazyUpdates {
+            bool pending{ false };          // are there any pending updates?
+            std::vector<LazyTag> tags;      // segment tree (node 'k' children are '2k+1' and '2k+2')
+        } m_lazy;
+
+        // cached derived node attributes (see 'registerAttribute')
+        template<typename A> struct AttributeState {
+            std::vector<A> values;                                              // cached attribute of each node (might be longer than tree)
+            std::function<A(const T&, const std::vector<const A*>&)> derive;    // attribute derivation function
+        };
+        struct AttributeSlot {
+            AttributeDependency dependency{};                                   // which nodes attribute depends on
+            std::vector<std::uint8_t> valid;                                    // is node cached attribute valid?
+            std::shared_ptr<void> state;                                        // attribute values and derivation function (AttributeState<A>)
+            void (*relocate)(void*, std::size_t, std::size_t){};                // move a cached attribute from one node index to another
+            std::shared_ptr<void> (*clone)(const void*){};                      // deep copy attribute state
+
+            AttributeSlot() = default;
+            AttributeSlot(const AttributeSlot& xi_other) : dependency(xi_other.dependency), valid(xi_other.valid), state(xi_other.clone(xi_other.state.get())),
+                                                           relocate(xi_other.relocate), clone(xi_other.clone) {}
+            AttributeSlot& operator=(const AttributeSlot& xi_other) {
+                if (this != &xi_other) *this = AttributeSlot(xi_other);
+                return *this;
+            }
+            AttributeSlot(AttributeSlot&&)            noexcept = default;
+            AttributeSlot& operator=(AttributeSlot&&) noexcept = default;
+        };
+        std::vector<AttributeSlot> m_attributes;
+
+        // sampled node access counters (see 'setAccessProfiling' and 'relayoutByHeat').
+        // counters are mutable since they are updated by const accessors, and are not updated atomically.
+        struct AccessProfile {
+            bool enabled{ false };              // are node accesses counted?
+            std::size_t sample_mask{};          // one of every 'sample_mask + 1' accesses is counted
+            std::size_t tick{};                 // amount of accesses since profiling was enabled
+            std::vector<std::uint32_t> heat;    // sampled access count of each node
+        };
+        mutable AccessProfile m_profile;
+
+        // last access pattern advised to allocators, and the collections it was advised on (see 'adviseAccess')
+        struct AccessAdvice {
+            AccessPattern pattern{ AccessPattern::Normal };
+            const void* data{};
+            const void* parent_index{};
+            std::size_t size{};
+        } m_advice;
+
+        // amount of gathered nodes which a sequential 'Traverse' prefetches ahead of the visited node (0 disables prefetching)
+        std::size_t m_prefetch_distance{ 8 };
+
+        // arity of best first traversal frontier heap (see 'traverseBestFirst')
+        static constexpr std::size_t frontier_arity{ 4 };
+
+        // trees of other node types (see 'join')
+        template<typename, class, class> friend class FlatTree;
 
     // member types
     public:
@@ -78,6 +237,25 @@ class FlatTree {
         explicit constexpr FlatTree(const T& xi_data) { m_parent_index.emplace_back(0); m_data.emplace_back(xi_data); }
         explicit constexpr FlatTree(T&& xi_data)      { m_parent_index.emplace_back(0); m_data.emplace_back(xi_data); }
 
+        // basic constructor (a tree which only has a root) using given allocator instances
+        FlatTree(const T& xi_data, const DataAllocator& xi_data_allocator, const IndexAllocator& xi_index_allocator) : m_data(xi_data_allocator), m_parent_index(xi_index_allocator) {
+            m_parent_index.emplace_back(0);
+            m_data.emplace_back(xi_data);
+        }
+        FlatTree(T&& xi_data, const DataAllocator& xi_data_allocator, const IndexAllocator& xi_index_allocator) : m_data(xi_data_allocator), m_parent_index(xi_index_allocator) {
+            m_parent_index.emplace_back(0);
+            m_data.emplace_back(std::move(xi_data));
+        }
+
+        // construct from two iterate-able collections using given allocator instances
+        template<typename C1, typename C2>
+        FlatTree(const C1& xi_data, const C2& xi_parent_index, const DataAllocator& xi_data_allocator, const IndexAllocator& xi_index_allocator) :
+            m_data(xi_data.begin(), xi_data.end(), xi_data_allocator), m_parent_index(xi_parent_index.begin(), xi_parent_index.end(), xi_index_allocator) {
+            static_assert(is_iterate_able_v<C1> && is_iterate_able_v<C2>, "input arguments are not iterate-able collections.");
+            assert(m_data.size() == m_parent_index.size() && " FlatTree input collections are not of equal size.");
+            assert(m_parent_index[0] == 0 && " root node must be the first node in tree.");
+        }
+
         // construct from two iterate-able collections
         template<typename C1, typename C2, typename std::enable_if<!is_vector_v<C1> && !is_vector_v<C2>>::type* = nullptr>
         explicit constexpr FlatTree(const C1& xi_data, const C2& xi_parent_index) {
@@ -138,15 +316,28 @@ class FlatTree {
     // iterators (allow iteration on all tree values)
     public:
 
-        auto begin()   noexcept -> decltype(m_data.begin())   { return m_data.begin();   }
-        auto rbegin()  noexcept -> decltype(m_data.rbegin())  { return m_data.rbegin();  }
-        auto cbegin()  noexcept -> decltype(m_data.cbegin())  { return m_data.cbegin();  }
-        auto crbegin() noexcept -> decltype(m_data.crbegin()) { return m_data.crbegin(); }
+        auto begin()   -> decltype(m_data.begin())   { materialize(); return m_data.begin();   }
+        auto rbegin()  -> decltype(m_data.rbegin())  { materialize(); return m_data.rbegin();  }
+        auto cbegin()  -> decltype(m_data.cbegin())  { materialize(); return m_data.cbegin();  }
+        auto crbegin() -> decltype(m_data.crbegin()) { materialize(); return m_data.crbegin(); }
+
+        auto end()   -> decltype(m_data.end())   { materialize(); return m_data.end();   }
+        auto rend()  -> decltype(m_data.rend())  { materialize(); return m_data.rend();  }
+        auto cend()  -> decltype(m_data.cend())  { materialize(); return m_data.cend();  }
+        auto crend() -> decltype(m_data.crend()) { materialize(); return m_data.crend(); }
+
+    // direct access to underlying (continuous) collections
+    public:
+
+        // return pointer to node values (pending sub-tree updates are applied first)
+        inline T* data() { materialize(); return m_data.data(); }
 
-        auto end()   noexcept -> decltype(m_data.end())   { return m_data.end();   }
-        auto rend()  noexcept -> decltype(m_data.rend())  { return m_data.rend();  }
-        auto cend()  noexcept -> decltype(m_data.cend())  { return m_data.cend();  }
-        auto crend() noexcept -> decltype(m_data.crend()) { return m_data.crend(); }
+        // return pointer to nodes parent index
+        inline const std::size_t* parentData() const noexcept { return m_parent_index.data(); }
+
+        // return allocators of node values and parent indices collections
+        inline DataAllocator  dataAllocator()  const noexcept { return m_data.get_allocator();         }
+        inline IndexAllocator indexAllocator() const noexcept { return m_parent_index.get_allocator(); }
 
     // capacity related functions
     public:
@@ -179,7 +370,8 @@ class FlatTree {
     public:
 
         // clear the tree content (maintains root node)
-        inline constexpr void clear() noexcept {
+        inline constexpr void clear() {
+            materialize();
             const T root{ m_data[0] };
 
             m_data.clear();
@@ -187,16 +379,22 @@ class FlatTree {
 
             m_data.emplace_back(root);
             m_parent_index.emplace_back(0);
+            ++m_structure_version;
+            resetAttributes();
         }
 
         // resize the tree to contain {@xi_count} elements
         inline constexpr void resize(const std::size_t xi_count) {
+            materialize();
             m_data.resize(xi_count);
             m_parent_index.resize(xi_count);
+            ++m_structure_version;
+            resetAttributes();
         }
 
         // return true if node (given by its index) exists
         inline constexpr bool doesIndexExist(const std::size_t xi_index) noexcept {
+            adviseAccess(AccessPattern::Sequential);
             const std::size_t len{ size() };
             return (len < size_for_parallelization)   ? 
                    doesIndexExistSequential(xi_index) : 
@@ -211,6 +409,7 @@ class FlatTree {
 
         // given node (given by its index), return the amount of first generation descendants
         inline constexpr std::size_t getNumOfDescendants(const std::size_t xi_parent_index) noexcept {      
+            adviseAccess(AccessPattern::Sequential);
             const std::size_t len{ size() };
             return (len < size_for_parallelization)        ? 
                    getNumOfDescendantsSequential(xi_parent_index) :
@@ -227,6 +426,7 @@ class FlatTree {
         template<typename C, typename std::enable_if<is_iterate_able_v<C>>::type* = nullptr>
         constexpr bool getDescendants(const std::size_t xi_parent_index, C& xo_descendants) {
             if (!isValid()) return false;
+            adviseAccess(AccessPattern::Sequential);
             if (xi_parent_index == 0) return false;
 
             // get descendants
@@ -247,6 +447,98 @@ class FlatTree {
             return xo_output;
         }
 
+        /**
+        * \brief given a set of nodes (given by their indices), return the amount of first generation descendants of each of them.
+        *        all queries are answered in a single (chunked, parallel for large trees) pass over parent indices,
+        *        i.e. - O(tree size + amount of queries) instead of O(tree size * amount of queries).
+        *        notice that root is not considered as its own descendant.
+        *
+        * @param {vector<size_t>, in}  queried nodes indices (might repeat)
+        * @param {vector<size_t>, out} amount of first generation descendants of each queried node (in query order)
+        * @param {bool,           out} true if operation was successful, false otherwise (invalid tree or node index)
+        **/
+        bool getNumOfDescendants(const std::vector<std::size_t>& xi_parents, std::vector<std::size_t>& xo_counts) {
+            std::vector<std::size_t> keys,
+                                     slots;
+            std::vector<std::uint64_t> queried;
+            std::vector<std::vector<std::size_t>> counts;
+            if (!countChildrenInChunks(xi_parents, keys, slots, queried, counts)) return false;
+
+            // sum chunks counts
+            std::vector<std::size_t> total(keys.size(), 0);
+            for (const std::vector<std::size_t>& chunk : counts) {
+                for (std::size_t k{}; k < keys.size(); ++k) total[k] += chunk[k];
+            }
+
+            xo_counts.resize(xi_parents.size());
+            for (std::size_t q{}; q < xi_parents.size(); ++q) {
+                xo_counts[q] = total[slots[q]];
+            }
+            return true;
+        }
+
+        /**
+        * \brief given a set of nodes (given by their indices), return the first generation descendants of each of them,
+        *        in compressed form - descendants of 'xi_parents[q]' are 'xo_descendants[xo_offset[q]]...xo_descendants[xo_offset[q + 1] - 1]'
+        *        (in index order). all queries are answered in two (chunked, parallel for large trees) passes over parent indices,
+        *        i.e. - O(tree size + amount of queries + output size) instead of O(tree size * amount of queries).
+        *        notice that root is not considered as its own descendant.
+        *
+        * @param {vector<size_t>, in}  queried nodes indices (might repeat)
+        * @param {vector<size_t>, out} offset of each query descendants in 'xo_descendants' (amount of queries + 1 entries)
+        * @param {vector<size_t>, out} descendants of all queried nodes
+        * @param {bool,           out} true if operation was successful, false otherwise (invalid tree or node index)
+        **/
+        bool getDescendants(const std::vector<std::size_t>& xi_parents, std::vector<std::size_t>& xo_offset, std::vector<std::size_t>& xo_descendants) {
+            std::vector<std::size_t> keys,
+                                     slots;
+            std::vector<std::uint64_t> queried;
+            std::vector<std::vector<std::size_t>> counts;
+            if (!countChildrenInChunks(xi_parents, keys, slots, queried, counts)) return false;
+
+            // position of each (chunk, queried node) descendants in unique queries output (chunk counts are turned into write positions)
+            std::vector<std::size_t> key_offset(keys.size() + 1, 0);
+            for (std::size_t k{}; k < keys.size(); ++k) {
+                std::size_t position{ key_offset[k] };
+                for (std::vector<std::size_t>& chunk : counts) {
+                    const std::size_t count{ chunk[k] };
+                    chunk[k]  = position;
+                    position += count;
+                }
+                key_offset[k + 1] = position;
+            }
+
+            // scatter descendants (notice that chunk index is deduced from its address)
+            std::vector<std::size_t> descendants(key_offset.back());
+            const std::size_t len{ size() },
+                              chunk_size{ (len + counts.size() - 1) / counts.size() };
+            const std::vector<std::size_t>* first_chunk{ counts.data() };
+            const auto scatter = [this, &keys, &queried, &descendants, len, chunk_size, first_chunk](std::vector<std::size_t>& position) {
+                const std::size_t c{ static_cast<std::size_t>(&position - first_chunk) };
+                for (std::size_t i{ std::max<std::size_t>(c * chunk_size, 1) }; i < std::min(len, (c + 1) * chunk_size); ++i) {
+                    const std::size_t p{ m_parent_index[i] };
+                    if ((queried[p / 64] >> (p % 64)) & 1) {
+                        descendants[position[static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), p) - keys.begin())]++] = i;
+                    }
+                }
+            };
+            if (counts.size() == 1) std::for_each(std::execution::seq, counts.begin(), counts.end(), scatter);
+            else                    std::for_each(std::execution::par, counts.begin(), counts.end(), scatter);
+
+            // arrange output in query order
+            xo_offset.resize(xi_parents.size() + 1);
+            xo_offset[0] = 0;
+            for (std::size_t q{}; q < xi_parents.size(); ++q) {
+                xo_offset[q + 1] = xo_offset[q] + key_offset[slots[q] + 1] - key_offset[slots[q]];
+            }
+            xo_descendants.clear();
+            xo_descendants.reserve(xo_offset.back());
+            for (std::size_t q{}; q < xi_parents.size(); ++q) {
+                xo_descendants.insert(xo_descendants.end(), descendants.begin() + key_offset[slots[q]], descendants.begin() + key_offset[slots[q] + 1]);
+            }
+            return true;
+        }
+
         /**
         * \brief return a collection holding all descendants of a given node (given by its index)
         *
@@ -270,6 +562,7 @@ class FlatTree {
         inline constexpr std::size_t getParentIndex(const std::size_t xi_index) {
             assert(isValid() && " tree structure is invalid");
             assert(xi_index < m_parent_index.size() && " node index is invalid");
+            recordAccess(xi_index);
             return (xi_index > 0) ? m_parent_index[xi_index] : 0;
         }
 
@@ -283,10 +576,13 @@ class FlatTree {
         inline constexpr bool insert(const std::size_t xi_parent_id, T&& xi_node) {
             // parent exists?
             if ((xi_parent_id >= m_parent_index.size()) || !isValid()) return false;
+            materialize();
 
             // insert node
             m_data.emplace_back(std::move(xi_node));
             m_parent_index.emplace_back(xi_parent_id);
+            ++m_structure_version;
+            attributesStructureChanged(xi_parent_id);
 
             // output
             return true;
@@ -297,34 +593,54 @@ class FlatTree {
 
             // parent exists?
             if ((xi_parent_id >= m_parent_index.size()) || !isValid()) return false;
+            materialize();
 
             for (auto&& node : xi_nodes) {
                 m_data.emplace_back(std::move(node));
                 m_parent_index.emplace_back(xi_parent_id);
             }
+            ++m_structure_version;
+            attributesStructureChanged(xi_parent_id);
 
             // output
             return true;
         }
 
         /**
-        * \brief remove a node (given by its index) and all its descendants
+        * \brief remove all descendants of a node (given by its index).
+        *        removed positions are filled by the last nodes, so indices of remaining nodes might change.
         * 
         * @param {size_t, in}  node index
         * @param {bool,   out} true if operarion was sucessfull, false otherwise
         **/
         constexpr bool remove(const std::size_t xi_parent_id) {
             if ((xi_parent_id >= m_parent_index.size()) || !isValid()) return false;
+            materialize();
 
             // get all descendants
             std::vector<std::size_t> descendants;
-            descendants.reserve(size());
-            const bool hasKids{ getAllDescendants(xi_parent_id, descendants) };
+            const bool hasKids{ gatherDescendants(xi_parent_id, descendants) };
             if (!hasKids) return false;
+            attributesStructureChanged(xi_parent_id);
 
-            // remove descendants
-            for (std::size_t kid : descendants) {
+            // remove descendants in descending index order, so a node moved into a removed position (the last node) is never
+            // a descendant which is yet to be removed. moved nodes positions are tracked, to remap parent indices of their children.
+            const std::size_t len{ size() };
+            std::vector<std::size_t> position(len),
+                                     origin(len);
+            std::iota(position.begin(), position.end(), 0);
+            std::iota(origin.begin(), origin.end(), 0);
+            std::sort(descendants.begin(), descendants.end(), std::greater<std::size_t>());
+            for (const std::size_t kid : descendants) {
+                const std::size_t last{ size() - 1 };
                 remove_node(kid);
+                if (kid != last) {
+                    origin[kid]           = origin[last];
+                    position[origin[kid]] = kid;
+                }
+            }
+            for (std::size_t& parent : m_parent_index) {
+                parent = position[parent];
             }
 
             // output
@@ -332,32 +648,961 @@ class FlatTree {
         }
 
         /**
-        * \brief out-of-order tree traversal from a given node (given by its index) "downwards" using a given execution policy
+        * \brief out-of-order tree traversal from a given node (given by its index) "downwards" using a given execution policy.
+        *        gathered descendants are kept in a per thread buffer which is reused across traversals.
+        * 
+        * @param {size_t,      in} index of node from which depth first search will be performed  
+        * @param {executer,    in} execution policy (std::execution::seq, std::execution::par, std::execution::par_unseq, std::execution::unseq)
+        * @param {function,    in} operation to be performed on descendants
+        * @param {GatherOrder, in} order in which descendants are visited (default is gathering order)
+        **/
+        template<class EXECUTER, class FUNC> inline void Traverse(const std::size_t xi_parent_index, EXECUTER&& xi_exec, FUNC&& xi_func, const GatherOrder xi_order = GatherOrder::Discovery) {
+            // notice that buffer is taken out of its slot during traversal, so a nested traversal allocates its own
+            std::vector<std::size_t>& slot{ traversalBuffer() };
+            std::vector<std::size_t> buffer;
+            buffer.swap(slot);
+            Traverse(xi_parent_index, std::forward<EXECUTER>(xi_exec), std::forward<FUNC>(xi_func), buffer, xi_order);
+            buffer.swap(slot);
+        }
+
+        /**
+        * \brief out-of-order tree traversal from a given node (given by its index) "downwards" using a given execution policy,
+        *        gathering descendants (through the structure index, first generation descendants followed by each of their sub-trees)
+        *        into a caller provided buffer (so its allocation is reused across traversals).
+        *        when visited under a sequential policy, the nodes 'prefetch distance' positions ahead of the visited one are prefetched (see 'setPrefetchDistance').
         * 
-        * @param {size_t,   in} index of node from which depth first search will be performed  
-        * @param {executer, in} execution policy (std::execution::seq, std::execution::par, std::execution::par_unseq, std::execution::unseq)
-        * @param {function, in} operation to be performed on descendants
+        * @param {size_t,      in}  index of node from which depth first search will be performed  
+        * @param {executer,    in}  execution policy (std::execution::seq, std::execution::par, std::execution::par_unseq, std::execution::unseq)
+        * @param {function,    in}  operation to be performed on descendants
+        * @param {vector,      out} scratch buffer (holds gathered descendants indices upon return)
+        * @param {GatherOrder, in}  order in which descendants are visited (default is gathering order)
         **/
-        template<class EXECUTER, class FUNC> inline constexpr void Traverse(const std::size_t xi_parent_index, EXECUTER&& xi_exec, FUNC&& xi_func) {
+        template<class EXECUTER, class FUNC> void Traverse(const std::size_t xi_parent_index, EXECUTER&& xi_exec, FUNC&& xi_func,
+                                                           std::vector<std::size_t>& xo_scratch, const GatherOrder xi_order = GatherOrder::Discovery) {
             // get all descendants
-            std::vector<std::size_t> descendants;
-            descendants.reserve(size());
-            const bool hasKids{ getAllDescendants(xi_parent_index, descendants) };
-            if (!hasKids) return;
-            
-            // apply function on descendants
-            std::for_each(std::forward<EXECUTER>(xi_exec), descendants.begin(), descendants.end(), [this, f = std::forward<FUNC>(xi_func)](auto& elm) mutable {
-                f(m_data[elm]);
+            if (!gatherDescendants(xi_parent_index, xo_scratch)) return;
+            materialize();
+            adviseAccess(AccessPattern::Random);
+            if (m_profile.enabled) {
+                for (const std::size_t i : xo_scratch) recordAccess(i);
+            }
+
+            // visit nodes in memory order
+            if (xi_order == GatherOrder::Sorted) {
+                if (xo_scratch.size() < size_for_parallelization) std::sort(std::execution::seq, xo_scratch.begin(), xo_scratch.end());
+                else                                               std::sort(std::execution::par, xo_scratch.begin(), xo_scratch.end());
+            }
+
+            // apply function on descendants, prefetching ahead when visited sequentially
+            // (parallel algorithms might hand buffer elements over as copies, so position in buffer can not be deduced from element address)
+            if constexpr (std::is_same_v<std::decay_t<EXECUTER>, std::execution::sequenced_policy>) {
+                const std::size_t len{ xo_scratch.size() },
+                                  distance{ m_prefetch_distance };
+                for (std::size_t i{}; i < len; ++i) {
+                    if ((distance > 0) && (i + distance < len)) prefetch(&m_data[xo_scratch[i + distance]]);
+                    xi_func(m_data[xo_scratch[i]]);
+                }
+            } else {
+                std::for_each(std::forward<EXECUTER>(xi_exec), xo_scratch.begin(), xo_scratch.end(), [this, f = std::forward<FUNC>(xi_func)](const std::size_t elm) mutable {
+                    f(m_data[elm]);
+                });
+            }
+        }
+
+        /**
+        * \brief set the amount of gathered nodes 'Traverse' prefetches ahead of the currently visited node (under a sequential policy).
+        *        larger distances suit larger nodes and heavier operations, 0 disables prefetching.
+        *
+        * @param {size_t, in} prefetch distance [nodes]
+        **/
+        inline void setPrefetchDistance(const std::size_t xi_distance) noexcept { m_prefetch_distance = xi_distance; }
+
+        /**
+        * \brief sort first generation descendants of every node according to a given key.
+        *        all sibling groups are sorted in parallel and the tree is then laid out in breadth first order, so that afterwards:
+        *        1) first generation descendants of every node are stored contiguously and ordered by their key.
+        *        2) parent index of every node is smaller than its own index, and parent indices are stored in ascending order
+        *           (which allows binary searching descendants of a given node, see 'findChild').
+        *        notice that this operation changes nodes indices.
+        *
+        * @param {function, in} key extraction function (node value -> comparable key)
+        **/
+        template<class KEY> void sortChildren(KEY&& xi_key) {
+            assert(isValid() && " tree structure is invalid");
+            materialize();
+            const std::size_t len{ size() };
+
+            // first generation descendants of each node
+            updateStructureIndex();
+            const std::vector<std::size_t>& offset{ m_index.child_offset };
+            std::vector<std::size_t> children{ m_index.children };
+
+            // sort each sibling group
+            const auto sortSiblings = [this, &offset, &children, &xi_key](const std::size_t p) {
+                if (offset[p + 1] - offset[p] < 2) return;
+                std::stable_sort(children.begin() + offset[p], children.begin() + offset[p + 1], [this, &xi_key](const std::size_t a, const std::size_t b) {
+                    return xi_key(m_data[a]) < xi_key(m_data[b]);
+                });
+            };
+            std::vector<std::size_t> parents(len);
+            std::iota(parents.begin(), parents.end(), 0);
+            if (len < size_for_parallelization) {
+                std::for_each(std::execution::seq, parents.begin(), parents.end(), sortSiblings);
+            } else {
+                std::for_each(std::execution::par, parents.begin(), parents.end(), sortSiblings);
+            }
+
+            // breadth first layout
+            std::vector<std::size_t>& order{ parents };
+            order.clear();
+            order.emplace_back(0);
+            for (std::size_t i{}; i < order.size(); ++i) {
+                const std::size_t p{ order[i] };
+                order.insert(order.end(), children.begin() + offset[p], children.begin() + offset[p + 1]);
+            }
+            assert(order.size() == len && " tree has nodes which are not connected to its root.");
+
+            std::vector<std::size_t> inverse(len);
+            for (std::size_t i{}; i < len; ++i) {
+                inverse[order[i]] = i;
+            }
+            applyPermutation(order, inverse);
+        }
+
+        /**
+        * \brief reorder tree nodes according to a given permutation, i.e. - node located at index 'xi_order[i]' is relocated to index 'i'.
+        *        permutation is validated (root must remain the first node), parent indices are remapped (in parallel for large trees).
+        *
+        * @param {vector<size_t>, in}  permutation
+        * @param {vector<size_t>, out} inverse permutation, i.e. - new index of node which was located at index 'i'
+        * @param {ReorderMode,    in}  how nodes are relocated (default is out of place)
+        * @param {bool,           out} true if tree was reordered, false if permutation is invalid (in which case tree is not modified)
+        **/
+        bool reorder(const std::vector<std::size_t>& xi_order, std::vector<std::size_t>& xo_inverse, const ReorderMode xi_mode = ReorderMode::OutOfPlace) {
+            const std::size_t len{ size() };
+            if ((xi_order.size() != len) || (xi_order[0] != 0)) return false;
+
+            // validate and invert
+            constexpr std::size_t none{ static_cast<std::size_t>(-1) };
+            xo_inverse.assign(len, none);
+            for (std::size_t i{}; i < len; ++i) {
+                const std::size_t from{ xi_order[i] };
+                if ((from >= len) || (xo_inverse[from] != none)) return false;
+                xo_inverse[from] = i;
+            }
+
+            applyPermutation(xi_order, xo_inverse, xi_mode);
+            return true;
+        }
+
+        /**
+        * \brief enable/disable sampled counting of node accesses (via 'operator[]', 'getParentIndex' and 'Traverse'), see 'relayoutByHeat'.
+        *        counters are kept when profiling is disabled. notice that counters are not updated atomically,
+        *        so accesses should not be profiled while tree is accessed concurrently.
+        *
+        * @param {bool,   in} should accesses be counted?
+        * @param {size_t, in} sampling period (rounded up to a power of two), i.e. - one of every 'period' accesses is counted
+        **/
+        void setAccessProfiling(const bool xi_enabled, const std::size_t xi_sample_period = 16) {
+            std::size_t period{ 1 };
+            while (period < xi_sample_period) period <<= 1;
+
+            m_profile.enabled     = xi_enabled;
+            m_profile.sample_mask = period - 1;
+            m_profile.tick        = 0;
+            m_profile.heat.resize(size(), 0);
+        }
+
+        // reset node access counters
+        void resetAccessProfile() {
+            m_profile.heat.assign(size(), 0);
+            m_profile.tick = 0;
+        }
+
+        // return sampled access count of a node (given by its index)
+        std::size_t getAccessCount(const std::size_t xi_index) const {
+            assert(xi_index < size() && " node index is invalid");
+            return (xi_index < m_profile.heat.size()) ? m_profile.heat[xi_index] : 0;
+        }
+
+        /**
+        * \brief relayout tree nodes according to their sampled access counts (see 'setAccessProfiling').
+        *        hottest nodes (in descending access count order), each preceded by its not yet placed ancestors (root first),
+        *        are packed at the front of the tree, followed by all other nodes in their current relative order.
+        *
+        * @param {vector<size_t>, out} inverse permutation, i.e. - new index of node which was located at index 'i' (see 'reorder')
+        * @param {double,         in}  fraction of tree nodes considered hot (default is 1%)
+        **/
+        void relayoutByHeat(std::vector<std::size_t>& xo_inverse, const double xi_hot_fraction = 0.01) {
+            assert(isValid() && " tree structure is invalid");
+            assert((xi_hot_fraction >= 0.0) && (xi_hot_fraction <= 1.0) && " hot fraction must be in the range [0, 1].");
+            const std::size_t len{ size() };
+            std::vector<std::uint32_t>& heat{ m_profile.heat };
+            heat.resize(len, 0);
+
+            // hottest nodes
+            std::vector<std::size_t> hot;
+            for (std::size_t i{}; i < len; ++i) {
+                if (heat[i] > 0) hot.emplace_back(i);
+            }
+            const std::size_t count{ std::min(hot.size(), static_cast<std::size_t>(std::ceil(xi_hot_fraction * static_cast<double>(len)))) };
+            const auto hotter = [&heat](const std::size_t a, const std::size_t b) { return (heat[a] > heat[b]) || ((heat[a] == heat[b]) && (a < b)); };
+            std::partial_sort(hot.begin(), hot.begin() + count, hot.end(), hotter);
+            hot.resize(count);
+
+            // hot nodes and their ancestors chains
+            std::vector<std::size_t> order;
+            std::vector<std::size_t> chain;
+            std::vector<bool> placed(len, false);
+            order.reserve(len);
+            order.emplace_back(0);
+            placed[0] = true;
+            for (const std::size_t h : hot) {
+                chain.clear();
+                for (std::size_t i{ h }; !placed[i]; i = m_parent_index[i]) {
+                    chain.emplace_back(i);
+                    placed[i] = true;
+                }
+                order.insert(order.end(), chain.rbegin(), chain.rend());
+            }
+
+            // cold nodes
+            for (std::size_t i{ 1 }; i < len; ++i) {
+                if (!placed[i]) order.emplace_back(i);
+            }
+
+            const bool succeed{ reorder(order, xo_inverse) };
+            assert(succeed && " tree has nodes which are not connected to its root.");
+        }
+
+        /**
+        * \brief binary search first generation descendants of a given node (given by its index) for a given key.
+        *        tree must be sorted (using 'sortChildren' with the same key) and not structurally modified since.
+        *
+        * @param {size_t,   in}  parent index
+        * @param {K,        in}  key to search for
+        * @param {function, in}  key extraction function (node value -> comparable key)
+        * @param {size_t,   out} index of found node
+        * @param {bool,     out} true if a descendant with the given key was found, false otherwise
+        **/
+        template<class K, class KEY> bool findChild(const std::size_t xi_parent_index, const K& xi_key, KEY&& xi_key_func, std::size_t& xo_index) {
+            assert(std::is_sorted(m_parent_index.begin() + 1, m_parent_index.end()) && " tree was not sorted using 'sortChildren'.");
+            if (!isValid()) return false;
+            materialize();
+            adviseAccess(AccessPattern::Random);
+
+            // sibling group
+            const auto siblings = std::equal_range(m_parent_index.begin() + 1, m_parent_index.end(), xi_parent_index);
+            const std::size_t first{ static_cast<std::size_t>(siblings.first  - m_parent_index.begin()) },
+                              last{  static_cast<std::size_t>(siblings.second - m_parent_index.begin()) };
+
+            // search group
+            const auto it = std::partition_point(m_data.begin() + first, m_data.begin() + last, [&xi_key, &xi_key_func](const T& node) {
+                return xi_key_func(node) < xi_key;
             });
+            if ((it == m_data.begin() + last) || (xi_key < xi_key_func(*it))) return false;
+
+            xo_index = static_cast<std::size_t>(it - m_data.begin());
+            return true;
+        }
+
+        /**
+        * \brief match the nodes of this tree with the nodes of another tree by their key path,
+        *        i.e. - two nodes are matched if their parents are matched and their keys are equal (roots are always matched).
+        *        both trees are descended in lockstep, and for each matched parent pair the keys of one group of first generation
+        *        descendants are hashed and probed by the other, so join is O(n) (expected).
+        *        sub-trees of matched root first generation descendants are joined concurrently for large trees.
+        *        siblings with equal keys are matched in index order (first with first, second with second, etc.).
+        *
+        * @param {FlatTree,                   in}  other tree
+        * @param {function,                   in}  key extraction function (node value -> hashable key), applied to nodes of both trees
+        * @param {vector<pair<size_t,size_t>>, out} matched nodes {index in this tree, index in other tree}, parents precede their descendants
+        **/
+        template<typename U, class DA, class IA, class KEY> void join(FlatTree<U, DA, IA>& xi_other, KEY&& xi_key, std::vector<std::pair<std::size_t, std::size_t>>& xo_pairs) {
+            using key_t = std::decay_t<std::invoke_result_t<KEY&, const T&>>;
+            assert(isValid() && xi_other.isValid() && " tree structure is invalid");
+            materialize();
+            xi_other.materialize();
+            updateStructureIndex();
+            xi_other.updateStructureIndex();
+            adviseAccess(AccessPattern::Random);
+            xi_other.adviseAccess(AccessPattern::Random);
+
+            // match first generation descendants of a matched pair, appending matched pairs to a given collection
+            const auto& a_offset   = m_index.child_offset;
+            const auto& a_children = m_index.children;
+            const auto& b_offset   = xi_other.m_index.child_offset;
+            const auto& b_children = xi_other.m_index.children;
+            const auto matchChildren = [&](const std::size_t a, const std::size_t b, std::vector<std::pair<std::size_t, std::size_t>>& xo_matched) {
+                const std::size_t a_first{ a_offset[a] }, a_last{ a_offset[a + 1] },
+                                  b_first{ b_offset[b] }, b_last{ b_offset[b + 1] };
+                if ((a_first == a_last) || (b_first == b_last)) return;
+
+                // small groups - scan
+                if ((a_last - a_first) * (b_last - b_first) <= 64) {
+                    std::uint64_t used{};
+                    for (std::size_t i{ a_first }; i < a_last; ++i) {
+                        const key_t key(xi_key(m_data[a_children[i]]));
+                        for (std::size_t j{ b_first }; j < b_last; ++j) {
+                            if (((used >> (j - b_first)) & 1) || !(xi_key(xi_other.m_data[b_children[j]]) == key)) continue;
+                            used |= std::uint64_t{ 1 } << (j - b_first);
+                            xo_matched.emplace_back(a_children[i], b_children[j]);
+                            break;
+                        }
+                    }
+                    return;
+                }
+
+                // large groups - hash other tree group (equal keys are chained in index order)
+                constexpr std::size_t none{ static_cast<std::size_t>(-1) };
+                std::unordered_map<key_t, std::size_t> head;
+                std::vector<std::size_t> next(b_last - b_first, none);
+                head.reserve(b_last - b_first);
+                for (std::size_t j{ b_last }; j > b_first; --j) {
+                    auto [it, inserted] = head.try_emplace(xi_key(xi_other.m_data[b_children[j - 1]]), j - 1 - b_first);
+                    if (!inserted) {
+                        next[j - 1 - b_first] = it->second;
+                        it->second = j - 1 - b_first;
+                    }
+                }
+                for (std::size_t i{ a_first }; i < a_last; ++i) {
+                    const auto it = head.find(xi_key(m_data[a_children[i]]));
+                    if ((it == head.end()) || (it->second == none)) continue;
+                    xo_matched.emplace_back(a_children[i], b_children[b_first + it->second]);
+                    it->second = next[it->second];
+                }
+            };
+
+            // roots and their first generation descendants
+            xo_pairs.clear();
+            xo_pairs.emplace_back(0, 0);
+            matchChildren(0, 0, xo_pairs);
+            const std::size_t top{ xo_pairs.size() };
+
+            // descend each matched root descendant sub-tree
+            std::vector<std::vector<std::pair<std::size_t, std::size_t>>> matched(top);
+            const auto descend = [&matched, &xo_pairs, &matchChildren](std::vector<std::pair<std::size_t, std::size_t>>& xio_matched) {
+                const std::size_t k{ static_cast<std::size_t>(&xio_matched - matched.data()) };
+                xio_matched.emplace_back(xo_pairs[k]);
+                for (std::size_t i{}; i < xio_matched.size(); ++i) {
+                    const auto [a, b] = xio_matched[i];
+                    matchChildren(a, b, xio_matched);
+                }
+            };
+            if (std::min(size(), xi_other.size()) < size_for_parallelization) {
+                std::for_each(std::execution::seq, matched.begin() + 1, matched.end(), descend);
+            } else {
+                std::for_each(std::execution::par, matched.begin() + 1, matched.end(), descend);
+            }
+
+            // gather
+            xo_pairs.resize(1);
+            for (const auto& m : matched) {
+                xo_pairs.insert(xo_pairs.end(), m.begin(), m.end());
+            }
+        }
+
+        // return node (given by its index) depth, i.e. - amount of edges between it and the root
+        inline std::size_t getDepth(const std::size_t xi_index) {
+            assert(isValid() && " tree structure is invalid");
+            assert(xi_index < m_parent_index.size() && " node index is invalid");
+            updateStructureIndex();
+            return m_index.depth[xi_index];
+        }
+
+        /**
+        * \brief return tree structural profile (child count of every node, fan-out and depth distributions, amount of leaves and height).
+        *        child counts and depths are taken from the structure index, and the distributions are then accumulated in a single pass
+        *        over nodes (in parallel chunks for large trees, each accumulating its own histograms, which are then summed).
+        *
+        * @param {TreeProfile, out} tree structural profile
+        **/
+        TreeProfile profile() {
+            assert(isValid() && " tree structure is invalid");
+            updateStructureIndex();
+            const std::size_t len{ size() };
+            const std::vector<std::size_t>& offset{ m_index.child_offset };
+            const std::vector<std::size_t>& depth{ m_index.depth };
+
+            TreeProfile xo_profile;
+            xo_profile.child_count.resize(len);
+
+            // per chunk histograms
+            constexpr std::size_t max_chunks{ 64 };
+            const std::size_t chunks{ (len < size_for_parallelization) ? 1 : std::min(max_chunks, (len + size_for_parallelization - 1) / size_for_parallelization) },
+                              chunk_size{ (len + chunks - 1) / chunks };
+            std::vector<TreeProfile> partial(chunks);
+
+            // notice that chunk index is deduced from its address
+            const TreeProfile* first_chunk{ partial.data() };
+            std::vector<std::size_t>& child_count{ xo_profile.child_count };
+            const auto accumulate = [&offset, &depth, &child_count, len, chunk_size, first_chunk](TreeProfile& chunk) {
+                const std::size_t c{ static_cast<std::size_t>(&chunk - first_chunk) };
+                for (std::size_t i{ c * chunk_size }; i < std::min(len, (c + 1) * chunk_size); ++i) {
+                    const std::size_t kids{ offset[i + 1] - offset[i] };
+                    child_count[i] = kids;
+                    if (kids >= chunk.fan_out.size())   chunk.fan_out.resize(kids + 1, 0);
+                    if (depth[i] >= chunk.width.size()) chunk.width.resize(depth[i] + 1, 0);
+                    ++chunk.fan_out[kids];
+                    ++chunk.width[depth[i]];
+                }
+            };
+            if (chunks == 1) std::for_each(std::execution::seq, partial.begin(), partial.end(), accumulate);
+            else             std::for_each(std::execution::par, partial.begin(), partial.end(), accumulate);
+
+            // sum histograms
+            for (const TreeProfile& chunk : partial) {
+                if (chunk.fan_out.size() > xo_profile.fan_out.size()) xo_profile.fan_out.resize(chunk.fan_out.size(), 0);
+                if (chunk.width.size()   > xo_profile.width.size())   xo_profile.width.resize(chunk.width.size(), 0);
+                for (std::size_t k{}; k < chunk.fan_out.size(); ++k) xo_profile.fan_out[k] += chunk.fan_out[k];
+                for (std::size_t d{}; d < chunk.width.size();   ++d) xo_profile.width[d]   += chunk.width[d];
+            }
+            xo_profile.leaves = xo_profile.fan_out.empty() ? 0 : xo_profile.fan_out[0];
+            xo_profile.height = xo_profile.width.empty()   ? 0 : xo_profile.width.size() - 1;
+
+            return xo_profile;
+        }
+
+        /**
+        * \brief return the lowest common ancestor of two nodes (given by their indices)
+        *
+        * @param {size_t, in}  first node index
+        * @param {size_t, in}  second node index
+        * @param {size_t, out} index of the deepest node which is an ancestor of both nodes (a node is considered an ancestor of itself)
+        **/
+        inline std::size_t getLowestCommonAncestor(const std::size_t xi_a, const std::size_t xi_b) {
+            assert(isValid() && " tree structure is invalid");
+            assert((xi_a < m_parent_index.size()) && (xi_b < m_parent_index.size()) && " node index is invalid");
+            updateStructureIndex();
+            return lowestCommonAncestor(xi_a, xi_b);
+        }
+
+        /**
+        * \brief return the distance (amount of edges along the path connecting them) between two nodes (given by their indices)
+        *
+        * @param {size_t, in}  first node index
+        * @param {size_t, in}  second node index
+        * @param {size_t, out} distance between nodes
+        **/
+        inline std::size_t distance(const std::size_t xi_a, const std::size_t xi_b) {
+            assert(isValid() && " tree structure is invalid");
+            assert((xi_a < m_parent_index.size()) && (xi_b < m_parent_index.size()) && " node index is invalid");
+            updateStructureIndex();
+            return nodesDistance(xi_a, xi_b);
+        }
+
+        /**
+        * \brief return the distance between each pair of nodes in a given collection.
+        *        queries are answered in ascending node index order (for memory locality), in parallel for large batches.
+        *
+        * @param {collection<pair<size_t, size_t>>, in}  collection of node pairs (given by their indices)
+        * @param {vector<size_t>,                   out} distance between each pair of nodes (in the order of input collection)
+        **/
+        template<typename C> void distance(const C& xi_pairs, std::vector<std::size_t>& xo_distances) {
+            static_assert(is_iterate_able_v<C> && has_size_method_v<C>, "input argument must be an iterate-able collection with a 'size' method.");
+            assert(isValid() && " tree structure is invalid");
+            updateStructureIndex();
+
+            const std::size_t len{ xi_pairs.size() };
+            std::vector<std::pair<std::size_t, std::size_t>> pairs(std::begin(xi_pairs), std::end(xi_pairs));
+            xo_distances.resize(len);
+
+            // order queries for locality
+            std::vector<std::size_t> order(len);
+            std::iota(order.begin(), order.end(), 0);
+            const auto byNodes = [&pairs](const std::size_t a, const std::size_t b) { return pairs[a] < pairs[b]; };
+            const auto solve   = [this, &pairs, &xo_distances](const std::size_t q) {
+                assert((pairs[q].first < m_parent_index.size()) && (pairs[q].second < m_parent_index.size()) && " node index is invalid");
+                xo_distances[q] = nodesDistance(pairs[q].first, pairs[q].second);
+            };
+            if (len < size_for_parallelization) {
+                std::sort(std::execution::seq, order.begin(), order.end(), byNodes);
+                std::for_each(std::execution::seq, order.begin(), order.end(), solve);
+            } else {
+                std::sort(std::execution::par, order.begin(), order.end(), byNodes);
+                std::for_each(std::execution::par, order.begin(), order.end(), solve);
+            }
+        }
+
+        /**
+        * \brief test if a node is an ancestor of another node (both given by their indices) in O(1), using the
+        *        pre-order entry/exit numbering of the structural index (which is lazily rebuilt after structural modifications).
+        *
+        * @param {size_t, in}  ancestor index
+        * @param {size_t, in}  node index
+        * @param {bool,   out} true if first node is an ancestor of second node (a node is considered an ancestor of itself)
+        **/
+        inline bool isAncestor(const std::size_t xi_ancestor, const std::size_t xi_node) {
+            assert(isValid() && " tree structure is invalid");
+            assert((xi_ancestor < m_parent_index.size()) && (xi_node < m_parent_index.size()) && " node index is invalid");
+            updateStructureIndex();
+            return isAncestorOf(xi_ancestor, xi_node);
+        }
+
+        /**
+        * \brief test a node against a collection of candidate ancestors.
+        *        candidates entry/exit numbers are gathered into contiguous buffers, which are then compared against node
+        *        in a branch free (vectorizable) manner.
+        *
+        * @param {collection<size_t>, in}  candidate ancestors (given by their indices)
+        * @param {size_t,             in}  node index
+        * @param {vector<uint8_t>,    out} for each candidate, 1 if it is an ancestor of node, 0 otherwise
+        * @param {bool,               out} true if any of the candidates is an ancestor of node
+        **/
+        template<typename C> bool isAncestor(const C& xi_candidates, const std::size_t xi_node, std::vector<std::uint8_t>& xo_results) {
+            static_assert(is_iterate_able_v<C>, "input argument must be an iterate-able collection.");
+            assert(isValid() && " tree structure is invalid");
+            assert(xi_node < m_parent_index.size() && " node index is invalid");
+            updateStructureIndex();
+
+            // gather
+            std::vector<std::size_t> entry, length;
+            if constexpr (has_size_method_v<C>) {
+                entry.reserve(xi_candidates.size());
+                length.reserve(xi_candidates.size());
+            }
+            for (const std::size_t c : xi_candidates) {
+                assert(c < m_parent_index.size() && " node index is invalid");
+                entry.emplace_back(m_index.preorder[c]);
+                length.emplace_back(m_index.subtree_size[c]);
+            }
+
+            // compare
+            const std::size_t len{ entry.size() },
+                              node{ m_index.preorder[xi_node] };
+            xo_results.resize(len);
+            const auto inside = [node](const std::size_t e, const std::size_t l) -> std::uint8_t { return (node - e) < l; };
+            if (len < size_for_parallelization) {
+                std::transform(std::execution::seq, entry.begin(), entry.end(), length.begin(), xo_results.begin(), inside);
+            } else {
+                std::transform(std::execution::par_unseq, entry.begin(), entry.end(), length.begin(), xo_results.begin(), inside);
+            }
+
+            return std::any_of(xo_results.begin(), xo_results.end(), [](const std::uint8_t r) { return r != 0; });
+        }
+
+        /**
+        * \brief build the virtual (auxiliary) tree of a given set of nodes, i.e. - a compact tree holding the given nodes and their
+        *        pairwise lowest common ancestors, in which each node parent is its closest ancestor in the set.
+        *        construction is O(k * log(k)) for a set of k nodes (once structural index is updated).
+        *
+        * @param {collection<size_t>, in}  nodes (given by their indices), must not be empty
+        * @param {FlatTree<size_t>,   out} virtual tree whose node values are the indices of nodes in this tree
+        **/
+        template<typename C> FlatTree<std::size_t> buildVirtualTree(const C& xi_nodes) {
+            static_assert(is_iterate_able_v<C>, "input argument must be an iterate-able collection.");
+            assert(isValid() && " tree structure is invalid");
+            updateStructureIndex();
+
+            const auto byPreorder = [this](const std::size_t a, const std::size_t b) { return m_index.preorder[a] < m_index.preorder[b]; };
+
+            // nodes in pre-order
+            std::vector<std::size_t> nodes(std::begin(xi_nodes), std::end(xi_nodes));
+            assert(!nodes.empty() && " virtual tree must hold at least one node.");
+            std::sort(nodes.begin(), nodes.end(), byPreorder);
+            nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+            // add lowest common ancestors of nodes which are adjacent in pre-order (this closes the set under lowest common ancestor)
+            const std::size_t k{ nodes.size() };
+            for (std::size_t i{ 1 }; i < k; ++i) {
+                nodes.emplace_back(lowestCommonAncestor(nodes[i - 1], nodes[i]));
+            }
+            std::sort(nodes.begin(), nodes.end(), byPreorder);
+            nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+            // connect each node to its closest ancestor in the set (first node is the virtual tree root)
+            std::vector<std::size_t> parent_index(nodes.size(), 0);
+            std::vector<std::size_t> stack{ 0 };
+            for (std::size_t i{ 1 }; i < nodes.size(); ++i) {
+                while (!isAncestorOf(nodes[stack.back()], nodes[i])) {
+                    stack.pop_back();
+                }
+                parent_index[i] = stack.back();
+                stack.emplace_back(i);
+            }
+
+            return FlatTree<std::size_t>(std::move(nodes), std::move(parent_index));
+        }
+
+        /**
+        * \brief return a new tree holding only the nodes which satisfy a given predicate (root is always kept).
+        *        nodes are marked (in parallel), surviving nodes are resolved top-down, and then compacted using a prefix sum
+        *        and scattered (in parallel) to the new tree. nodes retain their relative order.
+        *
+        * @param {function,   in}  predicate (const T& -> bool), might be invoked concurrently
+        * @param {FilterMode, in}  how nodes which do not satisfy the predicate are handled
+        * @param {FlatTree,   out} filtered tree
+        **/
+        template<class PRED> FlatTree filter(PRED&& xi_predicate, const FilterMode xi_mode) {
+            assert(isValid() && " tree structure is invalid");
+            materialize();
+            updateStructureIndex();
+            adviseAccess(AccessPattern::Sequential);
+            const std::size_t len{ size() };
+            const bool parallel{ len >= size_for_parallelization };
+
+            // mark
+            std::vector<std::size_t> keep(len);
+            const auto mark = [&xi_predicate](const T& node) -> std::size_t { return xi_predicate(node) ? 1 : 0; };
+            if (parallel) std::transform(std::execution::par, m_data.begin(), m_data.end(), keep.begin(), mark);
+            else          std::transform(std::execution::seq, m_data.begin(), m_data.end(), keep.begin(), mark);
+            keep[0] = 1;
+
+            // resolve top-down: pruned nodes lose their sub-tree, lifted nodes pass their nearest kept ancestor on to their descendants
+            std::vector<std::size_t> ancestor(m_parent_index.begin(), m_parent_index.end());
+            for (std::size_t i{ 1 }; i < len; ++i) {
+                const std::size_t node{ m_index.breadth_first[i] },
+                                  parent{ m_parent_index[node] };
+                if (xi_mode == FilterMode::Prune) {
+                    keep[node] &= keep[parent];
+                } else if (!keep[parent]) {
+                    ancestor[node] = ancestor[parent];
+                }
+            }
+
+            // compact
+            std::vector<std::size_t> position(len);
+            if (parallel) std::exclusive_scan(std::execution::par, keep.begin(), keep.end(), position.begin(), std::size_t{});
+            else          std::exclusive_scan(std::execution::seq, keep.begin(), keep.end(), position.begin(), std::size_t{});
+            const std::size_t count{ position[len - 1] + keep[len - 1] };
+
+            // scatter
+            std::vector<T, DataAllocator> data(count, m_data.get_allocator());
+            std::vector<std::size_t, IndexAllocator> parent_index(count, m_parent_index.get_allocator());
+            FlatTreeDetail::forEachIndex(len, size_for_parallelization, [this, &keep, &ancestor, &position, &data, &parent_index](const std::size_t i) {
+                if (!keep[i]) return;
+                data[position[i]]         = m_data[i];
+                parent_index[position[i]] = position[ancestor[i]];
+            });
+
+            FlatTree xo_tree(m_data[0], m_data.get_allocator(), m_parent_index.get_allocator());
+            xo_tree.m_data         = std::move(data);
+            xo_tree.m_parent_index = std::move(parent_index);
+            ++xo_tree.m_structure_version;
+            return xo_tree;
+        }
+
+        /**
+        * \brief visit every root-to-leaf path.
+        *        a path is handed to the visitor as a collection of node indices (starting with the root) held in a reused buffer,
+        *        i.e. - no allocation is performed per path. buffer content is valid only during the visitor invocation.
+        *
+        * @param {executer, in} execution policy (std::execution::seq, std::execution::par, ...); sub-trees of root first generation descendants are enumerated concurrently under a parallel policy
+        * @param {function, in} visitor (const std::vector<std::size_t>& path), invoked concurrently under a parallel policy
+        **/
+        template<class EXECUTER, class FUNC> void forEachPath(EXECUTER&& xi_exec, FUNC&& xi_func) {
+            assert(isValid() && " tree structure is invalid");
+            updateStructureIndex();
+            const std::vector<std::size_t>& offset{ m_index.child_offset };
+            const std::vector<std::size_t>& children{ m_index.children };
+
+            // tree with only a root
+            if (offset[0] == offset[1]) {
+                const std::vector<std::size_t> path{ 0 };
+                xi_func(path);
+                return;
+            }
+
+            // depth first enumeration of each root first generation descendant sub-tree.
+            // path buffers are per thread (taken out of their slot while in use, so a nested enumeration allocates its own).
+            const std::size_t height{ m_index.height };
+            std::for_each(std::forward<EXECUTER>(xi_exec), children.begin() + offset[0], children.begin() + offset[1], [&offset, &children, &xi_func, height](const std::size_t top) {
+                std::pair<std::vector<std::size_t>, std::vector<std::size_t>>& slot{ pathBuffers() };
+                std::vector<std::size_t> path;      // current path
+                std::vector<std::size_t> cursor;    // position (in 'children') of next descendant to visit, for each node in path
+                path.swap(slot.first);
+                cursor.swap(slot.second);
+                path.clear();
+                cursor.clear();
+                path.reserve(height + 1);
+                cursor.reserve(height + 1);
+                path.emplace_back(0);
+                path.emplace_back(top);
+                cursor.emplace_back(offset[1]);
+                cursor.emplace_back(offset[top]);
+
+                while (path.size() > 1) {
+                    const std::size_t node{ path.back() };
+
+                    // leaf
+                    if (offset[node] == offset[node + 1]) {
+                        xi_func(static_cast<const std::vector<std::size_t>&>(path));
+                        path.pop_back();
+                        cursor.pop_back();
+                    } // next descendant
+                    else if (cursor.back() < offset[node + 1]) {
+                        const std::size_t child{ children[cursor.back()++] };
+                        path.emplace_back(child);
+                        cursor.emplace_back(offset[child]);
+                    } // sub-tree exhausted
+                    else {
+                        path.pop_back();
+                        cursor.pop_back();
+                    }
+                }
+
+                path.swap(slot.first);
+                cursor.swap(slot.second);
+            });
+        }
+
+        /**
+        * \brief add a value to every node in a sub-tree rooted at a given node (given by its index), in O(log(n)).
+        *        update is lazy, and is applied to the tree values once they are accessed (see 'materialize').
+        *
+        * @param {size_t, in} sub-tree root index
+        * @param {T,      in} value to add (T must have a '+=' operator)
+        **/
+        void subtreeAdd(const std::size_t xi_index, const T& xi_value) {
+            static_assert(has_plus_assign_operator_v<T>, "tree node type must have a '+=' operator.");
+            subtreeUpdate(xi_index, LazyTag{ LazyTag::Kind::Add, xi_value });
+        }
+
+        /**
+        * \brief assign a value to every node in a sub-tree rooted at a given node (given by its index), in O(log(n)).
+        *        update is lazy, and is applied to the tree values once they are accessed (see 'materialize').
+        *
+        * @param {size_t, in} sub-tree root index
+        * @param {T,      in} value to assign
+        **/
+        void subtreeAssign(const std::size_t xi_index, const T& xi_value) {
+            subtreeUpdate(xi_index, LazyTag{ LazyTag::Kind::Assign, xi_value });
+        }
+
+        // return node (given by its index) value, including pending sub-tree updates, in O(log(n)) (tree values are not modified)
+        T pointRead(const std::size_t xi_index) const {
+            assert(xi_index < m_data.size() && " node index is invalid");
+            if (!m_lazy.pending) return m_data[xi_index];
+
+            // segments containing node position (root first)
+            std::size_t path[64];
+            std::size_t depth{},
+                        k{},
+                        first{},
+                        last{ size() };
+            const std::size_t position{ m_index.preorder[xi_index] };
+            path[depth++] = k;
+            while (last - first > 1) {
+                const std::size_t mid{ first + (last - first) / 2 };
+                if (position < mid) { k = 2 * k + 1; last  = mid; }
+                else                { k = 2 * k + 2; first = mid; }
+                path[depth++] = k;
+            }
+
+            // apply tags, oldest (deepest) first
+            T xo_value{ m_data[xi_index] };
+            while (depth > 0) {
+                applyTag(m_lazy.tags[path[--depth]], xo_value);
+            }
+            return xo_value;
+        }
+
+        // apply all pending sub-tree updates on tree values (done automatically once values are accessed through iterators or modified)
+        void materialize() {
+            if (!m_lazy.pending) return;
+            adviseAccess(AccessPattern::Sequential);
+
+            FlatTreeDetail::forEachIndex(size(), size_for_parallelization, [this](const std::size_t i) {
+                m_data[i] = pointRead(i);
+            });
+
+            std::fill(m_lazy.tags.begin(), m_lazy.tags.end(), LazyTag{});
+            m_lazy.pending = false;
+        }
+
+        // apply pending sub-tree updates on the value of a given node (given by its index), in O(log(n))
+        void materialize(const std::size_t xi_index) noexcept {
+            if (!m_lazy.pending) return;
+
+            // push tags down to the segment holding node position
+            std::size_t k{},
+                        first{},
+                        last{ size() };
+            const std::size_t position{ m_index.preorder[xi_index] };
+            while (last - first > 1) {
+                pushDown(k);
+                const std::size_t mid{ first + (last - first) / 2 };
+                if (position < mid) { k = 2 * k + 1; last  = mid; }
+                else                { k = 2 * k + 2; first = mid; }
+            }
+
+            applyTag(m_lazy.tags[k], m_data[xi_index]);
+            m_lazy.tags[k] = LazyTag{};
+        }
+
+        /**
+        * \brief visit the nodes of a sub-tree rooted at a given node (given by its index) in descending score order,
+        *        where only the first generation descendants of visited nodes are scored and added to the frontier.
+        *        frontier is a 4-ary heap kept in a per thread buffer which is reused across traversals, so no allocation is performed after the first traversals.
+        *
+        * @param {size_t,   in} sub-tree root index
+        * @param {function, in} node score function (const T& -> double)
+        * @param {function, in} visitor (size_t node index, double node score) -> bool, return false to stop traversal
+        * @param {double,   in} score bound - nodes scoring below it are neither visited nor expanded (default is to visit all nodes)
+        **/
+        template<class SCORE, class VISITOR>
+        void traverseBestFirst(const std::size_t xi_root, SCORE&& xi_score, VISITOR&& xi_visitor, const double xi_bound = -std::numeric_limits<double>::infinity()) {
+            static_assert(std::is_convertible_v<std::invoke_result_t<SCORE&, const T&>, double>, "score function must return a value convertible to double.");
+            static_assert(std::is_invocable_r_v<bool, VISITOR&, std::size_t, double>, "visitor must accept a node index and score and return a boolean.");
+            assert(isValid() && " tree structure is invalid");
+            assert(xi_root < size() && " node index is invalid");
+            materialize();
+            updateStructureIndex();
+            adviseAccess(AccessPattern::Random);
+            const std::vector<std::size_t>& offset{ m_index.child_offset };
+            const std::vector<std::size_t>& children{ m_index.children };
+
+            // notice that frontier is taken out of its slot during traversal, so a nested traversal allocates its own
+            std::vector<std::pair<double, std::size_t>>& slot{ frontierBuffer() };
+            std::vector<std::pair<double, std::size_t>> frontier;
+            frontier.swap(slot);
+            frontier.clear();
+            if (const double score{ static_cast<double>(xi_score(m_data[xi_root])) }; score >= xi_bound) {
+                frontierPush(frontier, score, xi_root);
+            }
+
+            while (!frontier.empty()) {
+                const auto [score, node] = frontier.front();
+                frontierPop(frontier);
+                if (!xi_visitor(node, score)) break;
+
+                for (std::size_t k{ offset[node] }; k < offset[node + 1]; ++k) {
+                    const double child_score{ static_cast<double>(xi_score(m_data[children[k]])) };
+                    if (child_score >= xi_bound) frontierPush(frontier, child_score, children[k]);
+                }
+            }
+            frontier.clear();
+            frontier.swap(slot);
+        }
+
+    // derived node attributes
+    public:
+
+        /**
+        * \brief register a derived node attribute, which is cached per node and lazily (re)derived once read (see 'attribute').
+        *        cached attributes are invalidated only for nodes affected by a modification:
+        *        1) attributes which depend on ancestors - modified node sub-tree.
+        *        2) attributes which depend on descendants - modified node and its ancestors.
+        *        notice that in-place modifications of node values (via 'operator[]', iterators or 'Traverse') are not tracked,
+        *        use 'set' or notify them using 'touch'.
+        *
+        * @param {A,                   in}  attribute type (should be default constructible)
+        * @param {AttributeDependency, in}  which nodes attribute depends on
+        * @param {function,            in}  attribute derivation function (const T& node value, const std::vector<const A*>& dependencies) -> A,
+        *                                   where dependencies are the parent attribute (none for root) or first generation descendants attributes
+        * @param {AttributeHandle<A>,  out} attribute handle
+        **/
+        template<typename A, class FUNC> AttributeHandle<A> registerAttribute(const AttributeDependency xi_dependency, FUNC&& xi_derive) {
+            static_assert(std::is_invocable_r_v<A, FUNC&, const T&, const std::vector<const A*>&>, "attribute derivation function signature is invalid.");
+            static_assert(std::is_default_constructible_v<A>, "attribute type must be default constructible.");
+
+            auto state = std::make_shared<AttributeState<A>>();
+            state->derive = std::forward<FUNC>(xi_derive);
+
+            AttributeSlot slot;
+            slot.dependency = xi_dependency;
+            slot.valid.assign(size(), 0);
+            slot.state      = std::move(state);
+            slot.relocate   = [](void* xio_state, const std::size_t xi_from, const std::size_t xi_to) {
+                std::vector<A>& values{ static_cast<AttributeState<A>*>(xio_state)->values };
+                if ((xi_from < values.size()) && (xi_to < values.size())) values[xi_to] = std::move(values[xi_from]);
+            };
+            slot.clone = [](const void* xi_state) -> std::shared_ptr<void> {
+                return std::make_shared<AttributeState<A>>(*static_cast<const AttributeState<A>*>(xi_state));
+            };
+            m_attributes.emplace_back(std::move(slot));
+
+            return AttributeHandle<A>{ m_attributes.size() - 1 };
+        }
+
+        /**
+        * \brief return derived attribute of a node (given by its index).
+        *        if cached attribute is invalid, it is derived along with the invalid attributes it depends on.
+        *
+        * @param {AttributeHandle<A>, in}  attribute handle
+        * @param {size_t,             in}  node index
+        * @param {A,                  out} node attribute (reference is valid until tree is modified)
+        **/
+        template<typename A> const A& attribute(const AttributeHandle<A> xi_attribute, const std::size_t xi_index) {
+            assert(xi_attribute.id < m_attributes.size() && " attribute is not registered on this tree.");
+            assert(xi_index < size() && " node index is invalid");
+            AttributeSlot& slot{ m_attributes[xi_attribute.id] };
+            AttributeState<A>& state{ *static_cast<AttributeState<A>*>(slot.state.get()) };
+            if (slot.valid[xi_index]) return state.values[xi_index];
+
+            assert(isValid() && " tree structure is invalid");
+            materialize();
+            adviseAccess(AccessPattern::Random);
+            if (state.values.size() < size()) {
+                state.values.resize(size());
+            }
+
+            std::vector<const A*> dependencies;
+            std::vector<std::size_t> pending{ xi_index };
+            const auto derive = [this, &slot, &state, &dependencies](const std::size_t node) {
+                state.values[node] = state.derive(m_data[node], static_cast<const std::vector<const A*>&>(dependencies));
+                slot.valid[node]   = 1;
+            };
+
+            if (slot.dependency == AttributeDependency::Ancestors) {
+                // invalid ancestors (an attribute is valid only if its parent attribute is valid), derived top-down
+                while ((pending.back() != 0) && !slot.valid[m_parent_index[pending.back()]]) {
+                    pending.emplace_back(m_parent_index[pending.back()]);
+                }
+                for (auto it{ pending.rbegin() }; it != pending.rend(); ++it) {
+                    dependencies.clear();
+                    if (*it != 0) dependencies.emplace_back(&state.values[m_parent_index[*it]]);
+                    derive(*it);
+                }
+            } else {
+                // invalid descendants (an attribute is valid only if its first generation descendants attributes are valid), derived bottom-up
+                updateStructureIndex();
+                const std::vector<std::size_t>& offset{ m_index.child_offset };
+                const std::vector<std::size_t>& children{ m_index.children };
+                while (!pending.empty()) {
+                    const std::size_t node{ pending.back() };
+                    bool ready{ true };
+                    for (std::size_t k{ offset[node] }; k < offset[node + 1]; ++k) {
+                        if (slot.valid[children[k]]) continue;
+                        pending.emplace_back(children[k]);
+                        ready = false;
+                    }
+                    if (!ready) continue;
+
+                    pending.pop_back();
+                    dependencies.clear();
+                    for (std::size_t k{ offset[node] }; k < offset[node + 1]; ++k) {
+                        dependencies.emplace_back(&state.values[children[k]]);
+                    }
+                    derive(node);
+                }
+            }
+
+            return state.values[xi_index];
+        }
+
+        // change the value of a node (given by its index), invalidating the cached attributes which depend on it
+        void set(const std::size_t xi_index, T xi_value) {
+            assert(xi_index < size() && " node index is invalid");
+            materialize(xi_index);
+            m_data[xi_index] = std::move(xi_value);
+            invalidateAttributes(xi_index, false);
+        }
+
+        // notify that the value of a node (given by its index) was modified in place, invalidating the cached attributes which depend on it
+        void touch(const std::size_t xi_index) {
+            assert(xi_index < size() && " node index is invalid");
+            invalidateAttributes(xi_index, false);
         }
 
     // output tree structure
     public:
 
         // output tree as a pair of {node value, node parent index}
-        inline constexpr void dumpToConsoleSimple() noexcept {
+        inline constexpr void dumpToConsoleSimple() {
             const std::size_t len{ size() };
             if (len == 0) return;
+            materialize();
 
             std::cout << m_data[0] << " {" << std::to_string(m_parent_index[0]) << "}";
             for (std::size_t i{1}; i < len; ++i) {
@@ -368,9 +1613,10 @@ class FlatTree {
 
         // output tree as a multi-map, i.e. - list of first generation descendants for each parent
         // notice that descendants are not printed in order
-        constexpr void dumpToConsoleMultiMap() noexcept {
+        constexpr void dumpToConsoleMultiMap() {
             const std::size_t len{ size() };
             if (len == 0) return;
+            materialize();
 
             // get unique parent id's
             std::vector<std::size_t> parents{ m_parent_index };         
@@ -419,8 +1665,8 @@ class FlatTree {
         }
 
         // get/change (but not insert!) node at a given index
-        const T  operator[](const std::size_t xi_index) const { assert(isValid() && (xi_index < size())); return m_data[xi_index]; }
-              T& operator[](const std::size_t xi_index)       { assert(isValid() && (xi_index < size())); return m_data[xi_index]; }
+        const T  operator[](const std::size_t xi_index) const { assert(isValid() && (xi_index < size())); recordAccess(xi_index); return pointRead(xi_index); }
+              T& operator[](const std::size_t xi_index)       { assert(isValid() && (xi_index < size())); recordAccess(xi_index); materialize(xi_index); return m_data[xi_index]; }
 
         // delete a list of nodes (given by their indices) and all their descendants
         // syntax is: 
@@ -466,10 +1712,506 @@ class FlatTree {
             // remove its parent index
             m_parent_index[xi_index] = m_parent_index[m_parent_index.size() - 1];
             m_parent_index.pop_back();
+            ++m_structure_version;
+
+            // relocate access counter and cached attributes of moved node
+            if (m_profile.heat.size() > m_data.size()) {
+                m_profile.heat[xi_index] = m_profile.heat[m_data.size()];
+                m_profile.heat.resize(m_data.size());
+            }
+            for (AttributeSlot& slot : m_attributes) {
+                slot.valid[xi_index] = slot.valid.back();
+                slot.valid.pop_back();
+                slot.relocate(slot.state.get(), slot.valid.size(), xi_index);
+            }
 
             assert(isValid() && " something went wrong when trying to remove a node from tree.");
         }
 
+        // advise allocators which accept access pattern hints (see 'has_advise_method') of the access pattern of the running operation.
+        // hint is issued only if pattern or collections changed since last advice.
+        void adviseAccess(const AccessPattern xi_pattern) noexcept {
+            if constexpr (has_advise_method_v<DataAllocator> || has_advise_method_v<IndexAllocator>) {
+                const AccessAdvice advice{ xi_pattern, m_data.data(), m_parent_index.data(), size() };
+                if ((advice.pattern == m_advice.pattern) && (advice.data == m_advice.data) &&
+                    (advice.parent_index == m_advice.parent_index) && (advice.size == m_advice.size)) return;
+                m_advice = advice;
+
+                if constexpr (has_advise_method_v<DataAllocator>) {
+                    m_data.get_allocator().advise(m_data.data(), m_data.size() * sizeof(T), xi_pattern);
+                }
+                if constexpr (has_advise_method_v<IndexAllocator>) {
+                    m_parent_index.get_allocator().advise(m_parent_index.data(), m_parent_index.size() * sizeof(std::size_t), xi_pattern);
+                }
+            }
+        }
+
+        // count an access of a node (given by its index) if profiling is enabled and access is sampled
+        inline void recordAccess(const std::size_t xi_index) const {
+            if (!m_profile.enabled || ((++m_profile.tick & m_profile.sample_mask) != 0)) return;
+            if (xi_index >= m_profile.heat.size()) m_profile.heat.resize(size(), 0);
+            if (m_profile.heat[xi_index] < std::numeric_limits<std::uint32_t>::max()) ++m_profile.heat[xi_index];
+        }
+
+        // best first frontier order (higher score first, lower index breaks ties)
+        static constexpr bool frontierBefore(const std::pair<double, std::size_t>& xi_a, const std::pair<double, std::size_t>& xi_b) noexcept {
+            return (xi_a.first > xi_b.first) || ((xi_a.first == xi_b.first) && (xi_a.second < xi_b.second));
+        }
+
+        // push a node into best first frontier
+        static void frontierPush(std::vector<std::pair<double, std::size_t>>& xio_frontier, const double xi_score, const std::size_t xi_index) {
+            std::size_t i{ xio_frontier.size() };
+            xio_frontier.emplace_back(xi_score, xi_index);
+            const std::pair<double, std::size_t> entry{ xio_frontier[i] };
+            while (i > 0) {
+                const std::size_t parent{ (i - 1) / frontier_arity };
+                if (!frontierBefore(entry, xio_frontier[parent])) break;
+                xio_frontier[i] = xio_frontier[parent];
+                i = parent;
+            }
+            xio_frontier[i] = entry;
+        }
+
+        // remove best node from best first frontier
+        static void frontierPop(std::vector<std::pair<double, std::size_t>>& xio_frontier) noexcept {
+            const std::pair<double, std::size_t> entry{ xio_frontier.back() };
+            xio_frontier.pop_back();
+            const std::size_t len{ xio_frontier.size() };
+            if (len == 0) return;
+
+            std::size_t i{};
+            for (;;) {
+                const std::size_t first{ frontier_arity * i + 1 };
+                if (first >= len) break;
+                std::size_t best{ first };
+                for (std::size_t c{ first + 1 }; c < std::min(first + frontier_arity, len); ++c) {
+                    if (frontierBefore(xio_frontier[c], xio_frontier[best])) best = c;
+                }
+                if (!frontierBefore(xio_frontier[best], entry)) break;
+                xio_frontier[i] = xio_frontier[best];
+                i = best;
+            }
+            xio_frontier[i] = entry;
+        }
+
+        // invalidate cached attributes affected by a modification of a node (given by its index) value, or of its entire sub-tree values
+        void invalidateAttributes(const std::size_t xi_index, const bool xi_subtree) {
+            if (m_attributes.empty()) return;
+            updateStructureIndex();
+            const std::vector<std::size_t>& offset{ m_index.child_offset };
+            const std::vector<std::size_t>& children{ m_index.children };
+
+            std::vector<std::size_t> pending;
+            for (AttributeSlot& slot : m_attributes) {
+                if (slot.dependency == AttributeDependency::Descendants) {
+                    invalidatePath(slot, xi_index);
+                    if (!xi_subtree) continue;
+                }
+
+                // sub-tree (attributes which depend on ancestors - an invalid attribute has invalid descendants attributes)
+                const bool prune{ slot.dependency == AttributeDependency::Ancestors };
+                pending.assign(1, xi_index);
+                while (!pending.empty()) {
+                    const std::size_t node{ pending.back() };
+                    pending.pop_back();
+                    if (prune && !slot.valid[node]) continue;
+
+                    slot.valid[node] = 0;
+                    pending.insert(pending.end(), children.begin() + offset[node], children.begin() + offset[node + 1]);
+                }
+            }
+        }
+
+        // update cached attributes after nodes were inserted under (or removed from) a given node
+        void attributesStructureChanged(const std::size_t xi_index) {
+            for (AttributeSlot& slot : m_attributes) {
+                slot.valid.resize(size(), 0);
+                if (slot.dependency == AttributeDependency::Descendants) {
+                    invalidatePath(slot, xi_index);
+                }
+            }
+        }
+
+        // invalidate cached attribute of a node (given by its index) and of its ancestors.
+        // an invalid attribute which depends on descendants has invalid ancestors attributes, so walk stops at the first invalid one.
+        void invalidatePath(AttributeSlot& xio_slot, const std::size_t xi_index) noexcept {
+            for (std::size_t i{ xi_index }; xio_slot.valid[i]; i = m_parent_index[i]) {
+                xio_slot.valid[i] = 0;
+                if (i == 0) break;
+            }
+        }
+
+        // invalidate all cached attributes (nodes were relocated)
+        void resetAttributes() {
+            for (AttributeSlot& slot : m_attributes) {
+                slot.valid.assign(size(), 0);
+            }
+        }
+
+        // apply a sub-tree update on the segment tree of pending updates
+        void subtreeUpdate(const std::size_t xi_index, const LazyTag& xi_tag) {
+            assert(isValid() && " tree structure is invalid");
+            assert(xi_index < m_parent_index.size() && " node index is invalid");
+            updateStructureIndex();
+
+            const std::size_t len{ size() };
+            if (m_lazy.tags.size() != 4 * len) {
+                m_lazy.tags.assign(4 * len, LazyTag{});
+            }
+
+            const std::size_t first{ m_index.preorder[xi_index] };
+            updateSegment(0, 0, len, first, first + m_index.subtree_size[xi_index], xi_tag);
+            m_lazy.pending = true;
+            invalidateAttributes(xi_index, true);
+        }
+
+        // apply a tag on all positions in range [xi_first, xi_last) of segment 'xi_k' (which covers [xi_segment_first, xi_segment_last))
+        void updateSegment(const std::size_t xi_k, const std::size_t xi_segment_first, const std::size_t xi_segment_last,
+                           const std::size_t xi_first, const std::size_t xi_last, const LazyTag& xi_tag) {
+            if ((xi_last <= xi_segment_first) || (xi_segment_last <= xi_first)) return;
+            if ((xi_first <= xi_segment_first) && (xi_segment_last <= xi_last)) {
+                composeTag(m_lazy.tags[xi_k], xi_tag);
+                return;
+            }
+
+            pushDown(xi_k);
+            const std::size_t mid{ xi_segment_first + (xi_segment_last - xi_segment_first) / 2 };
+            updateSegment(2 * xi_k + 1, xi_segment_first, mid, xi_first, xi_last, xi_tag);
+            updateSegment(2 * xi_k + 2, mid, xi_segment_last, xi_first, xi_last, xi_tag);
+        }
+
+        // move segment tag to its sub-segments
+        void pushDown(const std::size_t xi_k) noexcept {
+            LazyTag& tag{ m_lazy.tags[xi_k] };
+            if (tag.kind == LazyTag::Kind::None) return;
+            composeTag(m_lazy.tags[2 * xi_k + 1], tag);
+            composeTag(m_lazy.tags[2 * xi_k + 2], tag);
+            tag = LazyTag{};
+        }
+
+        // compose a newer tag over an older tag
+        static void composeTag(LazyTag& xio_older, const LazyTag& xi_newer) {
+            if (xi_newer.kind == LazyTag::Kind::None) return;
+            if ((xi_newer.kind == LazyTag::Kind::Assign) || (xio_older.kind == LazyTag::Kind::None)) {
+                xio_older = xi_newer;
+                return;
+            }
+
+            // addition over an addition/assignment
+            if constexpr (has_plus_assign_operator_v<T>) {
+                xio_older.value += xi_newer.value;
+            }
+        }
+
+        // apply a tag on a node value
+        static void applyTag(const LazyTag& xi_tag, T& xio_value) {
+            if (xi_tag.kind == LazyTag::Kind::Assign) {
+                xio_value = xi_tag.value;
+            } else if (xi_tag.kind == LazyTag::Kind::Add) {
+                if constexpr (has_plus_assign_operator_v<T>) {
+                    xio_value += xi_tag.value;
+                }
+            }
+        }
+
+        // build compressed first generation descendants index,
+        // i.e. - descendants of node 'i' are {xo_children[xo_offset[i]], ..., xo_children[xo_offset[i + 1] - 1]} (in ascending index order)
+        void buildChildIndex(std::vector<std::size_t>& xo_offset, std::vector<std::size_t>& xo_children) const {
+            const std::size_t len{ size() };
+
+            // count descendants
+            xo_offset.assign(len + 1, 0);
+            for (std::size_t i{ 1 }; i < len; ++i) {
+                ++xo_offset[m_parent_index[i] + 1];
+            }
+            std::partial_sum(xo_offset.begin(), xo_offset.end(), xo_offset.begin());
+
+            // scatter descendants
+            std::vector<std::size_t> cursor(xo_offset.begin(), xo_offset.end() - 1);
+            xo_children.resize(len > 0 ? len - 1 : 0);
+            for (std::size_t i{ 1 }; i < len; ++i) {
+                xo_children[cursor[m_parent_index[i]]++] = i;
+            }
+        }
+
+        // rebuild structural index if tree structure was modified since it was last built
+        void updateStructureIndex() {
+            if (m_index.version == m_structure_version) return;
+            adviseAccess(AccessPattern::Sequential);
+            const std::size_t len{ size() };
+
+            // first generation descendants
+            buildChildIndex(m_index.child_offset, m_index.children);
+
+            // breadth first order
+            std::vector<std::size_t>& order{ m_index.breadth_first };
+            order.clear();
+            order.reserve(len);
+            order.emplace_back(0);
+            for (std::size_t i{}; i < order.size(); ++i) {
+                const std::size_t p{ order[i] };
+                order.insert(order.end(), m_index.children.begin() + m_index.child_offset[p], m_index.children.begin() + m_index.child_offset[p + 1]);
+            }
+            assert(order.size() == len && " tree has nodes which are not connected to its root.");
+
+            // depth and jump pointers (Myers skew-binary ancestor pointers, allowing O(log(n)) level ancestor queries using O(n) memory)
+            m_index.depth.assign(len, 0);
+            m_index.jump.assign(len, 0);
+            m_index.height = 0;
+            for (std::size_t i{ 1 }; i < len; ++i) {
+                const std::size_t node{ order[i] },
+                                  parent{ m_parent_index[node] },
+                                  pjump{ m_index.jump[parent] };
+                m_index.depth[node] = m_index.depth[parent] + 1;
+                m_index.height      = std::max(m_index.height, m_index.depth[node]);
+                m_index.jump[node]  = (m_index.depth[parent] - m_index.depth[pjump] == m_index.depth[pjump] - m_index.depth[m_index.jump[pjump]]) ?
+                                      m_index.jump[pjump] : parent;
+            }
+
+            // sub-tree sizes (reverse breadth first order)
+            m_index.subtree_size.assign(len, 1);
+            for (std::size_t i{ len - 1 }; i > 0; --i) {
+                m_index.subtree_size[m_parent_index[order[i]]] += m_index.subtree_size[order[i]];
+            }
+
+            // pre-order numbering (a node sub-tree occupies the range [preorder, preorder + subtree_size))
+            m_index.preorder.assign(len, 0);
+            for (const std::size_t p : order) {
+                std::size_t next{ m_index.preorder[p] + 1 };
+                for (std::size_t k{ m_index.child_offset[p] }; k < m_index.child_offset[p + 1]; ++k) {
+                    const std::size_t c{ m_index.children[k] };
+                    m_index.preorder[c] = next;
+                    next += m_index.subtree_size[c];
+                }
+            }
+
+            m_index.version = m_structure_version;
+        }
+
+        // return the ancestor of a given node (given by its index) at a given depth (structural index must be updated)
+        inline std::size_t levelAncestor(std::size_t xi_index, const std::size_t xi_depth) const noexcept {
+            while (m_index.depth[xi_index] > xi_depth) {
+                xi_index = (m_index.depth[m_index.jump[xi_index]] >= xi_depth) ? m_index.jump[xi_index] : m_parent_index[xi_index];
+            }
+            return xi_index;
+        }
+
+        // return the lowest common ancestor of two nodes (structural index must be updated)
+        inline std::size_t lowestCommonAncestor(std::size_t xi_a, std::size_t xi_b) const noexcept {
+            if (m_index.depth[xi_a] > m_index.depth[xi_b]) xi_a = levelAncestor(xi_a, m_index.depth[xi_b]);
+            else                                           xi_b = levelAncestor(xi_b, m_index.depth[xi_a]);
+
+            // nodes at equal depth have jump pointers of equal depth
+            while (xi_a != xi_b) {
+                if (m_index.jump[xi_a] != m_index.jump[xi_b]) {
+                    xi_a = m_index.jump[xi_a];
+                    xi_b = m_index.jump[xi_b];
+                } else {
+                    xi_a = m_parent_index[xi_a];
+                    xi_b = m_parent_index[xi_b];
+                }
+            }
+            return xi_a;
+        }
+
+        // test if first node is an ancestor of (or equal to) second node (structural index must be updated).
+        // node is inside ancestor [entry, exit) pre-order range, i.e. - entry <= preorder < entry + subtree_size, which
+        // (using unsigned wrap around) is a single comparison.
+        inline bool isAncestorOf(const std::size_t xi_ancestor, const std::size_t xi_node) const noexcept {
+            return (m_index.preorder[xi_node] - m_index.preorder[xi_ancestor]) < m_index.subtree_size[xi_ancestor];
+        }
+
+        // return the distance between two nodes (structural index must be updated)
+        inline std::size_t nodesDistance(const std::size_t xi_a, const std::size_t xi_b) const noexcept {
+            return m_index.depth[xi_a] + m_index.depth[xi_b] - 2 * m_index.depth[lowestCommonAncestor(xi_a, xi_b)];
+        }
+
+        // re-arrange tree nodes such that node at index 'i' is the node which was previously located at index xi_order[i].
+        // xi_order must be a permutation which keeps the root in its place, xi_inverse is its inverse.
+        void applyPermutation(const std::vector<std::size_t>& xi_order, const std::vector<std::size_t>& xi_inverse, const ReorderMode xi_mode = ReorderMode::OutOfPlace) {
+            materialize();
+            const std::size_t len{ size() };
+            const bool parallel{ len >= size_for_parallelization };
+            assert(xi_order.size() == len && xi_inverse.size() == len && xi_order[0] == 0 && " invalid permutation.");
+
+            if (xi_mode == ReorderMode::OutOfPlace) {
+                std::vector<T, DataAllocator> data(len, m_data.get_allocator());
+                std::vector<std::size_t, IndexAllocator> parent_index(len, m_parent_index.get_allocator());
+                FlatTreeDetail::forEachIndex(len, size_for_parallelization, [this, &xi_order, &xi_inverse, &data, &parent_index](const std::size_t i) {
+                    const std::size_t from{ xi_order[i] };
+                    data[i]         = std::move(m_data[from]);
+                    parent_index[i] = xi_inverse[m_parent_index[from]];
+                });
+
+                m_data         = std::move(data);
+                m_parent_index = std::move(parent_index);
+            } else {
+                // remap parents
+                const auto remap = [&xi_inverse](const std::size_t parent) { return xi_inverse[parent]; };
+                if (parallel) std::transform(std::execution::par_unseq, m_parent_index.begin(), m_parent_index.end(), m_parent_index.begin(), remap);
+                else          std::transform(std::execution::seq,       m_parent_index.begin(), m_parent_index.end(), m_parent_index.begin(), remap);
+
+                // follow permutation cycles
+                std::vector<bool> done(len, false);
+                for (std::size_t first{ 1 }; first < len; ++first) {
+                    if (done[first] || (xi_order[first] == first)) continue;
+
+                    T value{ std::move(m_data[first]) };
+                    const std::size_t parent{ m_parent_index[first] };
+                    std::size_t i{ first };
+                    for (std::size_t from{ xi_order[i] }; from != first; i = from, from = xi_order[i]) {
+                        m_data[i]         = std::move(m_data[from]);
+                        m_parent_index[i] = m_parent_index[from];
+                        done[i] = true;
+                    }
+                    m_data[i]         = std::move(value);
+                    m_parent_index[i] = parent;
+                    done[i] = true;
+                }
+            }
+            ++m_structure_version;
+            resetAttributes();
+
+            // access counters follow their nodes
+            if (!m_profile.heat.empty()) {
+                m_profile.heat.resize(len, 0);
+                std::vector<std::uint32_t> heat(len);
+                for (std::size_t i{}; i < len; ++i) {
+                    heat[i] = m_profile.heat[xi_order[i]];
+                }
+                m_profile.heat = std::move(heat);
+            }
+        }
+
+        /**
+        * \brief count first generation descendants of a set of nodes in a single pass over parent indices.
+        *        parent indices are split to chunks (processed in parallel for large trees), each counting the children of every
+        *        (unique) queried node it holds. queried nodes are marked in a bitmap, so only children of queried nodes are searched for.
+        *
+        * @param {vector<size_t>,         in}  queried nodes indices
+        * @param {vector<size_t>,         out} unique queried nodes (sorted)
+        * @param {vector<size_t>,         out} position of each query in unique queried nodes
+        * @param {vector<uint64_t>,       out} queried nodes bitmap
+        * @param {vector<vector<size_t>>, out} per chunk amount of children of each unique queried node
+        * @param {bool,                   out} false if tree or a queried node index is invalid
+        **/
+        bool countChildrenInChunks(const std::vector<std::size_t>& xi_parents, std::vector<std::size_t>& xo_keys, std::vector<std::size_t>& xo_slots,
+                                   std::vector<std::uint64_t>& xo_queried, std::vector<std::vector<std::size_t>>& xo_counts) {
+            const std::size_t len{ size() };
+            if (!isValid()) return false;
+            if (std::any_of(xi_parents.begin(), xi_parents.end(), [len](const std::size_t p) { return p >= len; })) return false;
+            adviseAccess(AccessPattern::Sequential);
+
+            // unique queried nodes and their bitmap
+            xo_keys = xi_parents;
+            std::sort(xo_keys.begin(), xo_keys.end());
+            xo_keys.erase(std::unique(xo_keys.begin(), xo_keys.end()), xo_keys.end());
+            xo_slots.resize(xi_parents.size());
+            for (std::size_t q{}; q < xi_parents.size(); ++q) {
+                xo_slots[q] = static_cast<std::size_t>(std::lower_bound(xo_keys.begin(), xo_keys.end(), xi_parents[q]) - xo_keys.begin());
+            }
+            xo_queried.assign((len + 63) / 64, 0);
+            for (const std::size_t p : xo_keys) xo_queried[p / 64] |= std::uint64_t{ 1 } << (p % 64);
+
+            // amount of chunks (bounded, since each holds a counter per queried node)
+            constexpr std::size_t max_chunks{ 64 };
+            const std::size_t chunks{ (len < size_for_parallelization) ? 1 : std::min(max_chunks, (len + size_for_parallelization - 1) / size_for_parallelization) },
+                              chunk_size{ (len + chunks - 1) / chunks };
+            xo_counts.assign(chunks, std::vector<std::size_t>(xo_keys.size(), 0));
+
+            // count (notice that chunk index is deduced from its address)
+            const std::vector<std::size_t>* first_chunk{ xo_counts.data() };
+            const auto count = [this, &xo_keys, &xo_queried, len, chunk_size, first_chunk](std::vector<std::size_t>& counter) {
+                const std::size_t c{ static_cast<std::size_t>(&counter - first_chunk) };
+                for (std::size_t i{ std::max<std::size_t>(c * chunk_size, 1) }; i < std::min(len, (c + 1) * chunk_size); ++i) {
+                    const std::size_t p{ m_parent_index[i] };
+                    if ((xo_queried[p / 64] >> (p % 64)) & 1) {
+                        ++counter[static_cast<std::size_t>(std::lower_bound(xo_keys.begin(), xo_keys.end(), p) - xo_keys.begin())];
+                    }
+                }
+            };
+            if (chunks == 1) std::for_each(std::execution::seq, xo_counts.begin(), xo_counts.end(), count);
+            else             std::for_each(std::execution::par, xo_counts.begin(), xo_counts.end(), count);
+
+            return true;
+        }
+
+        // gather all descendants of a node (first generation descendants, followed by each of their sub-trees) using the structure index,
+        // return false if node has none
+        bool gatherDescendants(const std::size_t xi_parent_index, std::vector<std::size_t>& xo_descendants) {
+            xo_descendants.clear();
+            const std::size_t len{ size() };
+            if (!isValid() || (xi_parent_index >= len)) return false;
+
+            // all nodes but the root
+            if (xi_parent_index == 0) {
+                xo_descendants.resize(len - 1);
+                std::iota(xo_descendants.begin(), xo_descendants.end(), 1);
+                return len > 1;
+            }
+
+            // expand each node first generation descendants, and then (recursively) each of them, using a stack of unexpanded ranges
+            updateStructureIndex();
+            const std::vector<std::size_t>& offset{ m_index.child_offset };
+            const std::vector<std::size_t>& children{ m_index.children };
+            xo_descendants.reserve(m_index.subtree_size[xi_parent_index] - 1);
+            xo_descendants.insert(xo_descendants.end(), children.begin() + offset[xi_parent_index], children.begin() + offset[xi_parent_index + 1]);
+
+            // notice that the range stack is a per thread buffer (gathering never re-enters itself)
+            std::vector<std::pair<std::size_t, std::size_t>>& ranges{ gatherRanges() };
+            ranges.clear();
+            ranges.emplace_back(0, xo_descendants.size());
+            while (!ranges.empty()) {
+                auto& [next, last] = ranges.back();
+                if (next == last) {
+                    ranges.pop_back();
+                    continue;
+                }
+
+                const std::size_t node{ xo_descendants[next++] },
+                                  first{ xo_descendants.size() };
+                xo_descendants.insert(xo_descendants.end(), children.begin() + offset[node], children.begin() + offset[node + 1]);
+                if (xo_descendants.size() > first) ranges.emplace_back(first, xo_descendants.size());
+            }
+
+            return !xo_descendants.empty();
+        }
+
+        // this thread descendants gathering range stack (see 'gatherDescendants')
+        static std::vector<std::pair<std::size_t, std::size_t>>& gatherRanges() {
+            static thread_local std::vector<std::pair<std::size_t, std::size_t>> ranges;
+            return ranges;
+        }
+
+        // this thread path enumeration buffers {path, cursor} (see 'forEachPath')
+        static std::pair<std::vector<std::size_t>, std::vector<std::size_t>>& pathBuffers() {
+            static thread_local std::pair<std::vector<std::size_t>, std::vector<std::size_t>> buffers;
+            return buffers;
+        }
+
+        // this thread traversal buffer (see 'Traverse')
+        static std::vector<std::size_t>& traversalBuffer() {
+            static thread_local std::vector<std::size_t> buffer;
+            return buffer;
+        }
+
+        // this thread best first traversal frontier {score, node index} (see 'traverseBestFirst')
+        static std::vector<std::pair<double, std::size_t>>& frontierBuffer() {
+            static thread_local std::vector<std::pair<double, std::size_t>> frontier;
+            return frontier;
+        }
+
+        // prefetch (up to four cache lines of) a node
+        static inline void prefetch([[maybe_unused]] const T* xi_node) noexcept {
+#if defined(__GNUC__)
+            constexpr std::size_t cache_line{ 64 },
+                                  lines{ std::min<std::size_t>((sizeof(T) + cache_line - 1) / cache_line, 4) };
+            for (std::size_t i{}; i < lines; ++i) {
+                __builtin_prefetch(reinterpret_cast<const char*>(xi_node) + i * cache_line);
+            }
+#endif
+        }
+
         // sequential index searching
         inline constexpr bool doesIndexExistSequential(const std::size_t xi_index) noexcept {
             const auto iend = m_parent_index.end();
@@ -0,0 +1,611 @@
+/**
+* Flat tree Apache Arrow IPC stream export/import.
+*
+* Dan Israel Malta
+**/
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "FlatTreeIO.h"
+
+namespace FlatTreeArrowDetail {
+    static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "arrow export requires 64bit indices.");
+
+    // Arrow flatbuffer schema constants (Message.fbs, Schema.fbs)
+    inline constexpr std::int16_t  metadata_version_v5{ 4 };
+    inline constexpr std::uint8_t  header_schema{ 1 };
+    inline constexpr std::uint8_t  header_record_batch{ 3 };
+    inline constexpr std::uint8_t  type_int{ 2 };
+    inline constexpr std::uint8_t  type_floating_point{ 3 };
+    inline constexpr std::uint8_t  type_utf8{ 5 };
+    inline constexpr std::int16_t  precision_single{ 1 };
+    inline constexpr std::int16_t  precision_double{ 2 };
+    inline constexpr std::uint32_t continuation{ 0xFFFFFFFF };
+    inline constexpr std::size_t   body_alignment{ 64 };
+
+    inline constexpr std::size_t align(const std::size_t xi_length, const std::size_t xi_alignment) noexcept {
+        return (xi_length + xi_alignment - 1) & ~(xi_alignment - 1);
+    }
+
+    // Arrow type of a node value type
+    template<typename T, typename = void> struct ArrowType {
+        static constexpr bool supported{ false };
+    };
+    template<typename T> struct ArrowType<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+        static constexpr bool supported{ true };
+        static constexpr std::uint8_t type{ type_int };
+        static constexpr std::int32_t bit_width{ 8 * sizeof(T) };
+        static constexpr bool is_signed{ std::is_signed_v<T> };
+    };
+    template<typename T> struct ArrowType<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+        static constexpr bool supported{ sizeof(T) == 4 || sizeof(T) == 8 };
+        static constexpr std::uint8_t type{ type_floating_point };
+        static constexpr std::int16_t precision{ (sizeof(T) == 4) ? precision_single : precision_double };
+    };
+    template<> struct ArrowType<std::string> {
+        static constexpr bool supported{ true };
+        static constexpr std::uint8_t type{ type_utf8 };
+    };
+
+    /**
+    * \brief minimal flatbuffer builder. buffer is built back to front, an object "offset" is its distance from buffer end.
+    **/
+    class FlatBufferBuilder {
+
+        // properties
+        private:
+            std::vector<std::uint8_t> m_buffer;                                 // built buffer, in reverse order (last byte of buffer is first)
+            std::size_t m_alignment{ 1 };                                       // maximal alignment used
+            std::size_t m_table_start{};                                        // buffer size when current table was started
+            std::vector<std::pair<std::uint16_t, std::size_t>> m_table_fields;  // current table {field id, field offset}
+
+        // internal methods
+        private:
+
+            // prepend bytes (given in buffer order)
+            void prepend(const void* xi_data, const std::size_t xi_length) {
+                const std::uint8_t* data{ static_cast<const std::uint8_t*>(xi_data) };
+                for (std::size_t i{ xi_length }; i > 0; --i) {
+                    m_buffer.emplace_back(data[i - 1]);
+                }
+            }
+
+            // pad such that after prepending 'xi_length' bytes, buffer size is a multiple of 'xi_alignment'
+            void prealign(const std::size_t xi_length, const std::size_t xi_alignment) {
+                m_alignment = std::max(m_alignment, xi_alignment);
+                while ((m_buffer.size() + xi_length) % xi_alignment != 0) {
+                    m_buffer.emplace_back(0);
+                }
+            }
+
+            template<typename U> void prependScalar(const U xi_value) {
+                prealign(sizeof(U), sizeof(U));
+                prepend(&xi_value, sizeof(U));
+            }
+
+            void prependOffset(const std::size_t xi_target) {
+                prealign(sizeof(std::uint32_t), sizeof(std::uint32_t));
+                prependScalar(static_cast<std::uint32_t>(m_buffer.size() + sizeof(std::uint32_t) - xi_target));
+            }
+
+        // operations
+        public:
+
+            // return current offset
+            inline std::size_t offset() const noexcept { return m_buffer.size(); }
+
+            // create a string, return its offset
+            std::size_t createString(const std::string& xi_string) {
+                prealign(xi_string.size() + 1, sizeof(std::uint32_t));
+                m_buffer.emplace_back(0);
+                prepend(xi_string.data(), xi_string.size());
+                prependScalar(static_cast<std::uint32_t>(xi_string.size()));
+                return offset();
+            }
+
+            // create a vector of offsets, return its offset
+            std::size_t createOffsetVector(const std::vector<std::size_t>& xi_offsets) {
+                prealign(xi_offsets.size() * sizeof(std::uint32_t), sizeof(std::uint32_t));
+                for (std::size_t i{ xi_offsets.size() }; i > 0; --i) {
+                    prependOffset(xi_offsets[i - 1]);
+                }
+                prependScalar(static_cast<std::uint32_t>(xi_offsets.size()));
+                return offset();
+            }
+
+            // create a vector of structs made of 64bit integers, return its offset
+            std::size_t createStructVector(const std::vector<std::int64_t>& xi_values, const std::size_t xi_struct_length) {
+                assert(xi_values.size() % xi_struct_length == 0);
+                prealign(xi_values.size() * sizeof(std::int64_t), sizeof(std::uint32_t));
+                prealign(xi_values.size() * sizeof(std::int64_t), sizeof(std::int64_t));
+                for (std::size_t i{ xi_values.size() }; i > 0; --i) {
+                    prependScalar(xi_values[i - 1]);
+                }
+                prependScalar(static_cast<std::uint32_t>(xi_values.size() / xi_struct_length));
+                return offset();
+            }
+
+            // table construction
+            void startTable() {
+                m_table_fields.clear();
+                m_table_start = offset();
+            }
+            template<typename U> void addScalar(const std::uint16_t xi_id, const U xi_value) {
+                prependScalar(xi_value);
+                m_table_fields.emplace_back(xi_id, offset());
+            }
+            void addOffset(const std::uint16_t xi_id, const std::size_t xi_target) {
+                prependOffset(xi_target);
+                m_table_fields.emplace_back(xi_id, offset());
+            }
+            std::size_t endTable() {
+                // table starts with a (signed) offset to its vtable
+                prependScalar(std::int32_t{});
+                const std::size_t table{ offset() };
+
+                // vtable: {vtable length, table length, field offsets (relative to table start)}
+                std::uint16_t fields{};
+                for (const auto& f : m_table_fields) fields = std::max<std::uint16_t>(fields, f.first + 1);
+                std::vector<std::uint16_t> vtable(2 + fields, 0);
+                vtable[0] = static_cast<std::uint16_t>(vtable.size() * sizeof(std::uint16_t));
+                vtable[1] = static_cast<std::uint16_t>(table - m_table_start);
+                for (const auto& f : m_table_fields) {
+                    vtable[2 + f.first] = static_cast<std::uint16_t>(table - f.second);
+                }
+                for (std::size_t i{ vtable.size() }; i > 0; --i) {
+                    prependScalar(vtable[i - 1]);
+                }
+
+                // vtable precedes table (vtable = table - offset)
+                const std::int32_t relative{ static_cast<std::int32_t>(offset() - table) };
+                for (std::size_t i{}; i < sizeof(std::int32_t); ++i) {
+                    m_buffer[table - 1 - i] = static_cast<std::uint8_t>(static_cast<std::uint32_t>(relative) >> (8 * i));
+                }
+                return table;
+            }
+
+            // finish buffer with a given root table, return buffer (in buffer order) padded to a multiple of 8 bytes
+            std::vector<std::uint8_t> finish(const std::size_t xi_root) {
+                prealign(sizeof(std::uint32_t), std::max<std::size_t>(m_alignment, 8));
+                prependOffset(xi_root);
+                std::vector<std::uint8_t> xo_buffer(m_buffer.rbegin(), m_buffer.rend());
+                xo_buffer.resize(align(xo_buffer.size(), 8), 0);
+                return xo_buffer;
+            }
+    };
+
+    /**
+    * \brief minimal (bounds checked) flatbuffer table reader
+    **/
+    class FlatBufferTable {
+
+        // properties
+        private:
+            const std::uint8_t* m_buffer{};     // flatbuffer
+            std::size_t m_length{};             // flatbuffer length
+            std::size_t m_table{};              // table position
+            std::size_t m_vtable{};             // vtable position
+            std::uint16_t m_vtable_length{};    // vtable length
+
+        // internal methods
+        private:
+            template<typename U> bool load(const std::size_t xi_position, U& xo_value) const noexcept {
+                if ((xi_position > m_length) || (sizeof(U) > m_length - xi_position)) return false;
+                std::memcpy(&xo_value, m_buffer + xi_position, sizeof(U));
+                return true;
+            }
+
+            // return field position (0 if field is absent)
+            std::size_t field(const std::uint16_t xi_id) const noexcept {
+                std::uint16_t relative{};
+                const std::size_t entry{ 4 + 2 * static_cast<std::size_t>(xi_id) };
+                if ((entry + 2 > m_vtable_length) || !load(m_vtable + entry, relative)) return 0;
+                return (relative == 0) ? 0 : m_table + relative;
+            }
+
+            // follow an offset field
+            bool indirect(const std::uint16_t xi_id, std::size_t& xo_position) const noexcept {
+                const std::size_t position{ field(xi_id) };
+                std::uint32_t relative{};
+                if ((position == 0) || !load(position, relative)) return false;
+                xo_position = position + relative;
+                return xo_position < m_length;
+            }
+
+        // constructor
+        public:
+
+            FlatBufferTable() = default;
+
+            // root table of a buffer
+            FlatBufferTable(const std::uint8_t* xi_buffer, const std::size_t xi_length) : m_buffer(xi_buffer), m_length(xi_length) {
+                std::uint32_t root{};
+                if (load(0, root)) open(root);
+            }
+
+            // open a table located at a given position
+            bool open(const std::size_t xi_table) noexcept {
+                std::int32_t relative{};
+                if (!load(xi_table, relative)) return false;
+                const std::int64_t vtable{ static_cast<std::int64_t>(xi_table) - relative };
+                if ((vtable < 0) || !load(static_cast<std::size_t>(vtable), m_vtable_length)) return false;
+                m_table  = xi_table;
+                m_vtable = static_cast<std::size_t>(vtable);
+                return true;
+            }
+
+        // queries
+        public:
+
+            inline bool valid() const noexcept { return m_vtable_length >= 4; }
+
+            template<typename U> U scalar(const std::uint16_t xi_id, const U xi_default) const noexcept {
+                const std::size_t position{ field(xi_id) };
+                U value{ xi_default };
+                if (position != 0) load(position, value);
+                return value;
+            }
+
+            bool table(const std::uint16_t xi_id, FlatBufferTable& xo_table) const noexcept {
+                std::size_t position{};
+                xo_table.m_buffer = m_buffer;
+                xo_table.m_length = m_length;
+                return indirect(xi_id, position) && xo_table.open(position);
+            }
+
+            bool string(const std::uint16_t xi_id, std::string& xo_string) const {
+                std::size_t position{};
+                std::uint32_t length{};
+                if (!indirect(xi_id, position) || !load(position, length) || (length > m_length - position - 4)) return false;
+                xo_string.assign(reinterpret_cast<const char*>(m_buffer + position + 4), length);
+                return true;
+            }
+
+            // vector of tables
+            bool tables(const std::uint16_t xi_id, std::vector<FlatBufferTable>& xo_tables) const {
+                std::size_t position{};
+                std::uint32_t count{};
+                if (!indirect(xi_id, position) || !load(position, count)) return false;
+                xo_tables.assign(count, FlatBufferTable{});
+                for (std::uint32_t i{}; i < count; ++i) {
+                    const std::size_t element{ position + 4 + 4 * static_cast<std::size_t>(i) };
+                    std::uint32_t relative{};
+                    xo_tables[i].m_buffer = m_buffer;
+                    xo_tables[i].m_length = m_length;
+                    if (!load(element, relative) || !xo_tables[i].open(element + relative)) return false;
+                }
+                return true;
+            }
+
+            // vector of structs made of 64bit integers
+            bool structs(const std::uint16_t xi_id, const std::size_t xi_struct_length, std::vector<std::int64_t>& xo_values) const {
+                std::size_t position{};
+                std::uint32_t count{};
+                if (!indirect(xi_id, position) || !load(position, count)) return false;
+                xo_values.resize(static_cast<std::size_t>(count) * xi_struct_length);
+                for (std::size_t i{}; i < xo_values.size(); ++i) {
+                    if (!load(position + 4 + 8 * i, xo_values[i])) return false;
+                }
+                return true;
+            }
+    };
+
+    // write an encapsulated IPC message (continuation marker, metadata length, metadata)
+    inline bool writeMessage(const int xi_fd, const std::vector<std::uint8_t>& xi_metadata) {
+        const std::uint32_t prefix[2]{ continuation, static_cast<std::uint32_t>(xi_metadata.size()) };
+        return FlatTreeIODetail::writeAll(xi_fd, prefix, sizeof(prefix)) &&
+               FlatTreeIODetail::writeAll(xi_fd, xi_metadata.data(), xi_metadata.size());
+    }
+
+    // create an IPC message metadata
+    inline std::vector<std::uint8_t> makeMessage(FlatBufferBuilder& xio_builder, const std::uint8_t xi_header_type, const std::size_t xi_header, const std::int64_t xi_body_length) {
+        xio_builder.startTable();
+        xio_builder.addScalar<std::int64_t>(3, xi_body_length);
+        xio_builder.addOffset(2, xi_header);
+        xio_builder.addScalar<std::int16_t>(0, metadata_version_v5);
+        xio_builder.addScalar<std::uint8_t>(1, xi_header_type);
+        return xio_builder.finish(xio_builder.endTable());
+    }
+
+    // create a schema field
+    template<typename T> std::size_t makeField(FlatBufferBuilder& xio_builder, const std::string& xi_name) {
+        using type = ArrowType<T>;
+        const std::size_t name{ xio_builder.createString(xi_name) };
+        const std::size_t children{ xio_builder.createOffsetVector({}) };
+
+        xio_builder.startTable();
+        if constexpr (type::type == type_int) {
+            xio_builder.addScalar<std::int32_t>(0, type::bit_width);
+            xio_builder.addScalar<std::uint8_t>(1, type::is_signed);
+        } else if constexpr (type::type == type_floating_point) {
+            xio_builder.addScalar<std::int16_t>(0, type::precision);
+        }
+        const std::size_t arrow_type{ xio_builder.endTable() };
+
+        xio_builder.startTable();
+        xio_builder.addOffset(0, name);
+        xio_builder.addOffset(3, arrow_type);
+        xio_builder.addOffset(5, children);
+        xio_builder.addScalar<std::uint8_t>(1, 0);          // not nullable
+        xio_builder.addScalar<std::uint8_t>(2, type::type);
+        return xio_builder.endTable();
+    }
+
+    // amount of body buffers of a (non nested) schema field column (Schema.fbs 'Type' ids), return false for nested or unknown types,
+    // whose buffers (and those of the columns following them) can not be located
+    inline bool fieldBuffers(const FlatBufferTable& xi_field, std::size_t& xo_buffers) {
+        std::vector<FlatBufferTable> children;
+        if (xi_field.tables(5, children) && !children.empty()) return false;
+
+        switch (xi_field.scalar<std::uint8_t>(2, 0)) {
+            case 1:                                     // Null
+                xo_buffers = 0;
+                return true;
+            case type_int: case type_floating_point:    // Int, FloatingPoint, Bool, Decimal, Date, Time, Timestamp, Interval, FixedSizeBinary, Duration
+            case 6: case 7: case 8: case 9: case 10: case 11: case 15: case 18:
+                xo_buffers = 2;                         // validity, data
+                return true;
+            case 4: case type_utf8: case 19: case 20:   // Binary, Utf8, LargeBinary, LargeUtf8
+                xo_buffers = 3;                         // validity, offsets, data
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // test if a schema field type matches a given type
+    template<typename T> bool isFieldOfType(const FlatBufferTable& xi_field) {
+        using type = ArrowType<T>;
+        FlatBufferTable arrow_type;
+        if ((xi_field.scalar<std::uint8_t>(2, 0) != type::type) || !xi_field.table(3, arrow_type)) return false;
+
+        if constexpr (type::type == type_int) {
+            return (arrow_type.scalar<std::int32_t>(0, 0) == type::bit_width) && ((arrow_type.scalar<std::uint8_t>(1, 0) != 0) == type::is_signed);
+        } else if constexpr (type::type == type_floating_point) {
+            return arrow_type.scalar<std::int16_t>(0, 0) == type::precision;
+        } else {
+            return true;
+        }
+    }
+}
+
+namespace FlatTreeIO {
+
+    /**
+    * \brief write a tree as an Apache Arrow IPC stream, holding a schema and a single record batch with two non-nullable columns:
+    *        "parent" (uint64 parent index) and "value" (node value - integral, floating point or utf8 for std::string).
+    *        columns are written directly from the tree collections.
+    *
+    * @param {FlatTree, in}  tree
+    * @param {string,   in}  file path
+    * @param {bool,     out} true if tree was written, false otherwise
+    **/
+    template<typename T, class DataAllocator, class IndexAllocator>
+    bool saveArrow(FlatTree<T, DataAllocator, IndexAllocator>& xi_tree, const std::string& xi_path) {
+        using namespace FlatTreeArrowDetail;
+        static_assert(ArrowType<T>::supported, "tree node type has no arrow equivalent.");
+
+        const std::size_t len{ xi_tree.size() };
+        const T* values{ xi_tree.data() };
+
+        // body layout: {parent validity (empty), parent data, value validity (empty), [value offsets], value data}
+        std::vector<std::int32_t> offsets;
+        std::size_t values_length{ len * sizeof(T) };
+        if constexpr (std::is_same_v<T, std::string>) {
+            offsets.reserve(len + 1);
+            offsets.emplace_back(0);
+            std::size_t total{};
+            for (std::size_t i{}; i < len; ++i) {
+                total += values[i].size();
+                if (total > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) return false;
+                offsets.emplace_back(static_cast<std::int32_t>(total));
+            }
+            values_length = total;
+        }
+        std::vector<std::int64_t> buffers;  // {offset, length} pairs
+        std::size_t body{};
+        const auto addBuffer = [&buffers, &body](const std::size_t xi_length) {
+            buffers.emplace_back(static_cast<std::int64_t>(body));
+            buffers.emplace_back(static_cast<std::int64_t>(xi_length));
+            body += align(xi_length, body_alignment);
+        };
+        addBuffer(0);
+        addBuffer(len * sizeof(std::size_t));
+        addBuffer(0);
+        if constexpr (std::is_same_v<T, std::string>) addBuffer(offsets.size() * sizeof(std::int32_t));
+        addBuffer(values_length);
+
+        // schema message
+        FlatBufferBuilder schema_builder;
+        const std::size_t parent_field{ makeField<std::uint64_t>(schema_builder, "parent") },
+                          value_field{ makeField<T>(schema_builder, "value") },
+                          fields{ schema_builder.createOffsetVector({ parent_field, value_field }) };
+        schema_builder.startTable();
+        schema_builder.addOffset(1, fields);
+        schema_builder.addScalar<std::int16_t>(0, 0);   // little endian
+        const std::vector<std::uint8_t> schema{ makeMessage(schema_builder, header_schema, schema_builder.endTable(), 0) };
+
+        // record batch message
+        FlatBufferBuilder batch_builder;
+        const std::int64_t length{ static_cast<std::int64_t>(len) };
+        const std::size_t nodes{ batch_builder.createStructVector({ length, 0, length, 0 }, 2) },
+                          buffer_list{ batch_builder.createStructVector(buffers, 2) };
+        batch_builder.startTable();
+        batch_builder.addScalar<std::int64_t>(0, length);
+        batch_builder.addOffset(1, nodes);
+        batch_builder.addOffset(2, buffer_list);
+        const std::vector<std::uint8_t> batch{ makeMessage(batch_builder, header_record_batch, batch_builder.endTable(), static_cast<std::int64_t>(body)) };
+
+        // write stream (into a uniquely named temporary file, which is removed if writing fails)
+        std::string temporary;
+        if (!FlatTreeIODetail::makeTemporary(xi_path, temporary)) return false;
+        const int fd{ ::open(temporary.c_str(), O_WRONLY | O_TRUNC) };
+        if (fd < 0) {
+            ::unlink(temporary.c_str());
+            return false;
+        }
+
+        static const std::uint8_t padding[body_alignment]{};
+        const auto writeBuffer = [fd](const void* xi_data, const std::size_t xi_length) {
+            return FlatTreeIODetail::writeAll(fd, xi_data, xi_length) &&
+                   FlatTreeIODetail::writeAll(fd, padding, align(xi_length, body_alignment) - xi_length);
+        };
+        bool written{ writeMessage(fd, schema) && writeMessage(fd, batch) && writeBuffer(xi_tree.parentData(), len * sizeof(std::size_t)) };
+        if constexpr (std::is_same_v<T, std::string>) {
+            written = written && writeBuffer(offsets.data(), offsets.size() * sizeof(std::int32_t));
+            for (std::size_t i{}; written && (i < len); ++i) {
+                written = FlatTreeIODetail::writeAll(fd, values[i].data(), values[i].size());
+            }
+            written = written && FlatTreeIODetail::writeAll(fd, padding, align(values_length, body_alignment) - values_length);
+        } else {
+            written = written && writeBuffer(values, values_length);
+        }
+        const std::uint32_t end_of_stream[2]{ continuation, 0 };
+        written = written && FlatTreeIODetail::writeAll(fd, end_of_stream, sizeof(end_of_stream)) && (::fsync(fd) == 0);
+        const bool closed{ ::close(fd) == 0 };
+
+        if (written && closed && (::rename(temporary.c_str(), xi_path.c_str()) == 0)) return true;
+        ::unlink(temporary.c_str());
+        return false;
+    }
+
+    /**
+    * \brief read a tree from an Apache Arrow IPC stream (as written by 'saveArrow').
+    *        stream is memory mapped, its schema must hold a non-nullable "parent" (uint64) column and a "value" column
+    *        matching the tree node type. other columns are skipped, as long as they are not nested (streams with nested columns are rejected).
+    *        all record batches in the stream are concatenated.
+    *
+    * @param {string,   in}  file path
+    * @param {FlatTree, out} loaded tree
+    * @param {bool,     out} true if tree was loaded, false otherwise (in which case output tree is not modified)
+    **/
+    template<typename T, class DataAllocator, class IndexAllocator>
+    bool loadArrow(const std::string& xi_path, FlatTree<T, DataAllocator, IndexAllocator>& xo_tree) {
+        using namespace FlatTreeArrowDetail;
+        static_assert(ArrowType<T>::supported, "tree node type has no arrow equivalent.");
+        constexpr bool is_string{ std::is_same_v<T, std::string> };
+
+        // map stream
+        const int fd{ ::open(xi_path.c_str(), O_RDONLY) };
+        if (fd < 0) return false;
+        struct stat info {};
+        if ((::fstat(fd, &info) != 0) || (info.st_size == 0)) {
+            ::close(fd);
+            return false;
+        }
+        const std::size_t file_length{ static_cast<std::size_t>(info.st_size) };
+        void* mapped{ ::mmap(nullptr, file_length, PROT_READ, MAP_PRIVATE, fd, 0) };
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        const std::uint8_t* file{ static_cast<const std::uint8_t*>(mapped) };
+
+        std::vector<std::size_t> parents,
+                                 field_buffers;    // amount of body buffers of each schema column
+        std::vector<T> values;
+        std::size_t parent_column{ 2 },
+                    value_column{ 2 },
+                    position{};
+        bool succeed{ true },
+             has_schema{ false };
+        while (succeed && (position + 4 <= file_length)) {
+            // message prefix (continuation marker is optional in legacy streams)
+            std::uint32_t metadata_length{};
+            std::memcpy(&metadata_length, file + position, 4);
+            position += 4;
+            if (metadata_length == continuation) {
+                if (position + 4 > file_length) break;
+                std::memcpy(&metadata_length, file + position, 4);
+                position += 4;
+            }
+            if (metadata_length == 0) break;
+            if (metadata_length > file_length - position) { succeed = false; break; }
+
+            const FlatBufferTable message(file + position, metadata_length);
+            position += metadata_length;
+            const std::int64_t body_length{ message.scalar<std::int64_t>(3, 0) };
+            if (!message.valid() || (body_length < 0) || (static_cast<std::size_t>(body_length) > file_length - position)) { succeed = false; break; }
+            const std::uint8_t* body{ file + position };
+            position += static_cast<std::size_t>(body_length);
+
+            FlatBufferTable header;
+            if (!message.table(2, header)) { succeed = false; break; }
+            const std::uint8_t header_type{ message.scalar<std::uint8_t>(1, 0) };
+
+            // schema - locate columns
+            if (header_type == header_schema) {
+                std::vector<FlatBufferTable> fields;
+                succeed = header.tables(1, fields);
+                field_buffers.assign(fields.size(), 0);
+                for (std::size_t i{}; succeed && (i < fields.size()); ++i) {
+                    succeed = fieldBuffers(fields[i], field_buffers[i]);
+                    std::string name;
+                    fields[i].string(0, name);
+                    if ((name == "parent") && isFieldOfType<std::uint64_t>(fields[i]))  parent_column = i;
+                    else if ((name == "value") && isFieldOfType<T>(fields[i]))          value_column  = i;
+                }
+                succeed    = succeed && (parent_column < fields.size()) && (value_column < fields.size());
+                has_schema = succeed;
+                continue;
+            }
+            if ((header_type != header_record_batch) || !has_schema) continue;
+
+            // record batch - locate column buffers (each column buffers, as derived from its schema type, follow those of previous columns)
+            std::vector<std::int64_t> nodes, buffers;
+            if (!header.structs(1, 2, nodes) || !header.structs(2, 2, buffers)) { succeed = false; break; }
+            const std::int64_t length{ header.scalar<std::int64_t>(0, 0) };
+            const std::size_t columns{ nodes.size() / 2 };
+            std::vector<std::size_t> first_buffer(columns + 1, 0);
+            for (std::size_t c{}; (c < columns) && (c < field_buffers.size()); ++c) {
+                first_buffer[c + 1] = first_buffer[c] + field_buffers[c];
+            }
+            if ((columns != field_buffers.size()) || (2 * first_buffer[columns] > buffers.size()) ||
+                (nodes[2 * parent_column + 1] != 0) || (nodes[2 * value_column + 1] != 0) || (length < 0)) { succeed = false; break; }
+            const auto buffer = [&](const std::size_t xi_index, const std::size_t xi_expected, const std::uint8_t*& xo_data) {
+                const std::int64_t offset{ buffers[2 * xi_index] },
+                                   size{ buffers[2 * xi_index + 1] };
+                if ((offset < 0) || (size < static_cast<std::int64_t>(xi_expected)) || (offset + size > body_length)) return false;
+                xo_data = body + offset;
+                return true;
+            };
+
+            const std::size_t count{ static_cast<std::size_t>(length) },
+                              previous{ parents.size() };
+            const std::uint8_t* data{};
+            if (!buffer(first_buffer[parent_column] + 1, count * sizeof(std::size_t), data)) { succeed = false; break; }
+            parents.resize(previous + count);
+            std::memcpy(parents.data() + previous, data, count * sizeof(std::size_t));
+
+            if constexpr (is_string) {
+                const std::uint8_t* offsets_data{};
+                const std::uint8_t* chars{};
+                if (!buffer(first_buffer[value_column] + 1, (count + 1) * sizeof(std::int32_t), offsets_data)) { succeed = false; break; }
+                std::vector<std::int32_t> offsets(count + 1);
+                std::memcpy(offsets.data(), offsets_data, offsets.size() * sizeof(std::int32_t));
+                if (!buffer(first_buffer[value_column] + 2, static_cast<std::size_t>(std::max(offsets[count], 0)), chars)) { succeed = false; break; }
+                values.reserve(previous + count);
+                for (std::size_t i{}; succeed && (i < count); ++i) {
+                    succeed = (offsets[i] >= 0) && (offsets[i] <= offsets[i + 1]) && (offsets[i + 1] <= offsets[count]);
+                    if (succeed) values.emplace_back(reinterpret_cast<const char*>(chars) + offsets[i], static_cast<std::size_t>(offsets[i + 1] - offsets[i]));
+                }
+            } else {
+                if (!buffer(first_buffer[value_column] + 1, count * sizeof(T), data)) { succeed = false; break; }
+                values.resize(previous + count);
+                std::memcpy(values.data() + previous, data, count * sizeof(T));
+            }
+        }
+        ::munmap(mapped, file_length);
+
+        if (!succeed || !FlatTreeIODetail::isValidParents(parents)) return false;
+        FlatTreeIODetail::assignTree(xo_tree, std::move(values), std::move(parents));
+        return true;
+    }
+}
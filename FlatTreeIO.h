@@ -0,0 +1,838 @@
+/**
+* Flat tree serialization.
+*
+* Dan Israel Malta
+**/
+#pragma once
+#include <vector>
+#include <string>
+#include <future>
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <execution>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <type_traits>
+#include <limits>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define FLAT_TREE_IO_URING
+#endif
+#include "FlatTree.h"
+
+namespace FlatTreeIODetail {
+    static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "tree file format requires 64bit indices.");
+
+    // file header
+    struct FileHeader {
+        char          magic[8];     // "FLATTREE"
+        std::uint32_t version;      // format version
+        std::uint32_t value_size;   // sizeof(T)
+        std::uint64_t size;         // amount of nodes
+        std::uint64_t reserved[5];
+    };
+    static_assert(sizeof(FileHeader) == 64, "tree file header must be 64 bytes long.");
+
+    inline constexpr char          magic[8]{ 'F', 'L', 'A', 'T', 'T', 'R', 'E', 'E' };
+    inline constexpr std::uint32_t raw_version{ 1 };        // header, parent indices (size * uint64), node values (size * T)
+    inline constexpr std::uint32_t compressed_version{ 2 }; // header (reserved[0] is nodes per block), block table, compressed blocks (see 'BlockEntry')
+
+    // compressed file block table entry.
+    // table holds all parent index blocks followed by all node value blocks, block 'k' holds nodes [k * nodes per block, (k + 1) * nodes per block).
+    struct BlockEntry {
+        std::uint64_t offset;   // block offset in file
+        std::uint64_t length;   // compressed block length
+        std::uint32_t checksum; // compressed block CRC-32
+        std::uint32_t reserved;
+    };
+    static_assert(sizeof(BlockEntry) == 24, "tree file block entry must be 24 bytes long.");
+
+    // create a header for a given tree
+    template<typename T> inline FileHeader makeHeader(const std::uint32_t xi_version, const std::size_t xi_size) noexcept {
+        FileHeader header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version    = xi_version;
+        header.value_size = sizeof(T);
+        header.size       = xi_size;
+        return header;
+    }
+
+    // test if a header matches a given node type
+    template<typename T> inline bool isValidHeader(const FileHeader& xi_header) noexcept {
+        return (std::memcmp(xi_header.magic, magic, sizeof(magic)) == 0) && (xi_header.value_size == sizeof(T)) && (xi_header.size > 0);
+    }
+
+    // test if the length of an open file matches a raw tree image holding the amount of nodes its header declares
+    // (checked before anything is allocated, so a corrupt header can not drive allocations)
+    template<typename T> inline bool isRawImageLength(const int xi_fd, const FileHeader& xi_header) noexcept {
+        struct stat info {};
+        if ((::fstat(xi_fd, &info) != 0) || (info.st_size < static_cast<off_t>(sizeof(FileHeader)))) return false;
+        const std::uint64_t payload{ static_cast<std::uint64_t>(info.st_size) - sizeof(FileHeader) },
+                            node{ sizeof(std::size_t) + sizeof(T) };
+        return (xi_header.size <= payload / node) && (xi_header.size * node == payload);
+    }
+
+    // test if loaded parent indices form a valid tree structure (root is first, every parent is a node in tree)
+    inline bool isValidParents(const std::vector<std::size_t>& xi_parents) {
+        const std::size_t len{ xi_parents.size() };
+        return (len > 0) && (xi_parents[0] == 0) && std::all_of(xi_parents.begin(), xi_parents.end(), [len](const std::size_t p) { return p < len; });
+    }
+
+    // write/read an entire buffer (system calls only)
+    inline bool writeAll(const int xi_fd, const void* xi_buffer, std::size_t xi_length) noexcept {
+        const char* buffer{ static_cast<const char*>(xi_buffer) };
+        while (xi_length > 0) {
+            const ssize_t written{ ::write(xi_fd, buffer, xi_length) };
+            if (written <= 0) return false;
+            buffer    += written;
+            xi_length -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+    inline bool readAll(const int xi_fd, void* xi_buffer, std::size_t xi_length) noexcept {
+        char* buffer{ static_cast<char*>(xi_buffer) };
+        while (xi_length > 0) {
+            const ssize_t count{ ::read(xi_fd, buffer, xi_length) };
+            if (count <= 0) return false;
+            buffer    += count;
+            xi_length -= static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+
+    // create a uniquely named (empty) temporary file next to a given path, so concurrent writers of the same target do not collide
+    inline bool makeTemporary(const std::string& xi_path, std::string& xo_temporary) {
+        xo_temporary = xi_path + ".XXXXXX";
+        const int fd{ ::mkstemp(xo_temporary.data()) };
+        if (fd < 0) return false;
+        const bool created{ ::fchmod(fd, 0644) == 0 };
+        ::close(fd);
+        if (!created) ::unlink(xo_temporary.c_str());
+        return created;
+    }
+
+    // test if an allocator storage is shared across processes (declares 'is_shared_mapping' as true), i.e. - not copy-on-write after fork
+    template<typename A, typename = void> struct is_shared_mapping                                            : std::false_type {};
+    template<typename A>                  struct is_shared_mapping<A, std::void_t<typename A::is_shared_mapping>> : A::is_shared_mapping {};
+    template<typename A> inline constexpr bool is_shared_mapping_v = is_shared_mapping<A>::value;
+
+    // write a raw tree image into a temporary file and then rename it, so a complete file is always observed.
+    // performs no memory allocation (can be called in a forked child of a multi threaded process).
+    template<typename T> inline bool writeImage(const char* xi_path, const char* xi_temporary_path,
+                                                const std::size_t* xi_parents, const T* xi_values, const std::size_t xi_size) noexcept {
+        const int fd{ ::open(xi_temporary_path, O_WRONLY | O_CREAT | O_TRUNC, 0644) };
+        if (fd < 0) return false;
+
+        const FileHeader header{ makeHeader<T>(raw_version, xi_size) };
+        const bool written{ writeAll(fd, &header, sizeof(FileHeader))                     &&
+                            writeAll(fd, xi_parents, xi_size * sizeof(std::size_t))       &&
+                            writeAll(fd, xi_values, xi_size * sizeof(T))                  &&
+                            (::fsync(fd) == 0) };
+        const bool closed{ ::close(fd) == 0 };
+
+        return written && closed && (::rename(xi_temporary_path, xi_path) == 0);
+    }
+
+    // copy the part of a file range [xi_offset, xi_offset + xi_length) held in a buffer which overlaps a file region [xi_region, xi_region + xi_region_length)
+    inline void copyOverlap(const char* xi_buffer, const std::uint64_t xi_offset, const std::size_t xi_length,
+                            const std::uint64_t xi_region, const std::uint64_t xi_region_length, void* xo_region) noexcept {
+        const std::uint64_t first{ std::max(xi_offset, xi_region) },
+                            last{ std::min(xi_offset + xi_length, xi_region + xi_region_length) };
+        if (first >= last) return;
+        std::memcpy(static_cast<char*>(xo_region) + (first - xi_region), xi_buffer + (first - xi_offset), last - first);
+    }
+
+    // CRC-32 (IEEE 802.3 polynomial)
+    inline std::uint32_t crc32(const std::uint8_t* xi_data, const std::size_t xi_length) noexcept {
+        struct Table {
+            std::uint32_t entry[256];
+            constexpr Table() : entry() {
+                for (std::uint32_t i{}; i < 256; ++i) {
+                    std::uint32_t c{ i };
+                    for (int k{}; k < 8; ++k) {
+                        c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                    }
+                    entry[i] = c;
+                }
+            }
+        };
+        static constexpr Table table;
+
+        std::uint32_t crc{ 0xFFFFFFFFu };
+        for (std::size_t i{}; i < xi_length; ++i) {
+            crc = table.entry[(crc ^ xi_data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    // variable length (7 bits per byte) unsigned integer encoding
+    inline void putVarint(std::vector<std::uint8_t>& xo_out, std::uint64_t xi_value) {
+        while (xi_value >= 0x80) {
+            xo_out.emplace_back(static_cast<std::uint8_t>(xi_value | 0x80));
+            xi_value >>= 7;
+        }
+        xo_out.emplace_back(static_cast<std::uint8_t>(xi_value));
+    }
+    inline bool getVarint(const std::uint8_t*& xio_in, const std::uint8_t* xi_end, std::uint64_t& xo_value) noexcept {
+        xo_value = 0;
+        for (unsigned shift{}; (xio_in < xi_end) && (shift < 64); shift += 7) {
+            const std::uint8_t byte{ *xio_in++ };
+            xo_value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    /**
+    * \brief parent index codec: zigzag encoded differences between consecutive parent indices, bit packed using the
+    *        smallest width which holds all of them. block layout is {uint8_t width, packed differences}.
+    **/
+    inline void encodeParents(const std::size_t* xi_parents, const std::size_t xi_count, std::vector<std::uint8_t>& xo_block) {
+        const auto zigzag = [](const std::size_t current, const std::size_t previous) -> std::uint64_t {
+            const std::int64_t delta{ static_cast<std::int64_t>(current - previous) };
+            return (static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63);
+        };
+
+        std::uint64_t bits{};
+        for (std::size_t i{}; i < xi_count; ++i) {
+            bits |= zigzag(xi_parents[i], (i > 0) ? xi_parents[i - 1] : 0);
+        }
+        unsigned width{};
+        while ((width < 64) && (bits >> width) != 0) ++width;
+
+        xo_block.reserve(1 + (xi_count * width + 7) / 8);
+        xo_block.emplace_back(static_cast<std::uint8_t>(width));
+        std::uint64_t accumulator{};
+        unsigned pending{};
+        for (std::size_t i{}; i < xi_count; ++i) {
+            const std::uint64_t value{ zigzag(xi_parents[i], (i > 0) ? xi_parents[i - 1] : 0) };
+            for (unsigned done{}; done < width;) {
+                const unsigned take{ std::min(width - done, 32u) };
+                accumulator |= ((value >> done) & ((std::uint64_t{ 1 } << take) - 1)) << pending;
+                pending += take;
+                done    += take;
+                for (; pending >= 8; pending -= 8, accumulator >>= 8) {
+                    xo_block.emplace_back(static_cast<std::uint8_t>(accumulator));
+                }
+            }
+        }
+        if (pending > 0) xo_block.emplace_back(static_cast<std::uint8_t>(accumulator));
+    }
+    inline bool decodeParents(const std::uint8_t* xi_block, const std::size_t xi_length, std::size_t* xo_parents, const std::size_t xi_count) noexcept {
+        if (xi_length < 1) return false;
+        const unsigned width{ xi_block[0] };
+        if ((width > 64) || (xi_length < 1 + (xi_count * width + 7) / 8)) return false;
+
+        const std::uint8_t* in{ xi_block + 1 };
+        std::uint64_t accumulator{};
+        unsigned available{};
+        std::size_t previous{};
+        for (std::size_t i{}; i < xi_count; ++i) {
+            std::uint64_t value{};
+            for (unsigned done{}; done < width;) {
+                const unsigned take{ std::min(width - done, 32u) };
+                for (; available < take; available += 8) {
+                    accumulator |= static_cast<std::uint64_t>(*in++) << available;
+                }
+                value     |= (accumulator & ((std::uint64_t{ 1 } << take) - 1)) << done;
+                accumulator >>= take;
+                available  -= take;
+                done       += take;
+            }
+            const std::int64_t delta{ static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1) };
+            previous = static_cast<std::size_t>(static_cast<std::int64_t>(previous) + delta);
+            xo_parents[i] = previous;
+        }
+        return true;
+    }
+
+    /**
+    * \brief byte oriented LZ77 codec (used for node values).
+    *        block is a sequence of {varint literals length, literals, varint match length, varint match offset},
+    *        terminated by a zero match length. matches are found using a hash of the next four bytes.
+    **/
+    inline void encodeBytes(const std::uint8_t* xi_data, const std::size_t xi_length, std::vector<std::uint8_t>& xo_block) {
+        constexpr std::size_t min_match{ 4 };
+        constexpr unsigned hash_bits{ 14 };
+        std::vector<std::size_t> last(std::size_t{ 1 } << hash_bits, static_cast<std::size_t>(-1));
+        const auto hash = [xi_data](const std::size_t i) {
+            std::uint32_t word{};
+            std::memcpy(&word, xi_data + i, sizeof(word));
+            return (word * 2654435761u) >> (32 - hash_bits);
+        };
+
+        xo_block.reserve(xi_length / 2 + 16);
+        std::size_t literal{},
+                    i{};
+        while (i + min_match <= xi_length) {
+            const std::uint32_t h{ hash(i) };
+            const std::size_t candidate{ last[h] };
+            last[h] = i;
+
+            if ((candidate == static_cast<std::size_t>(-1)) || (std::memcmp(xi_data + candidate, xi_data + i, min_match) != 0)) {
+                ++i;
+                continue;
+            }
+
+            std::size_t length{ min_match };
+            while ((i + length < xi_length) && (xi_data[candidate + length] == xi_data[i + length])) ++length;
+
+            putVarint(xo_block, i - literal);
+            xo_block.insert(xo_block.end(), xi_data + literal, xi_data + i);
+            putVarint(xo_block, length);
+            putVarint(xo_block, i - candidate);
+
+            i      += length;
+            literal = i;
+        }
+
+        putVarint(xo_block, xi_length - literal);
+        xo_block.insert(xo_block.end(), xi_data + literal, xi_data + xi_length);
+        putVarint(xo_block, 0);
+    }
+    // (when no output buffer is given, block is only verified to decode into exactly xi_data_length bytes)
+    inline bool decodeBytes(const std::uint8_t* xi_block, const std::size_t xi_length, std::uint8_t* xo_data, const std::size_t xi_data_length) noexcept {
+        const std::uint8_t* in{ xi_block };
+        const std::uint8_t* const end{ xi_block + xi_length };
+        std::size_t out{};
+        for (;;) {
+            std::uint64_t literals{},
+                          length{},
+                          offset{};
+            if (!getVarint(in, end, literals) || (literals > static_cast<std::uint64_t>(end - in)) || (literals > xi_data_length - out)) return false;
+            if (xo_data != nullptr) std::memcpy(xo_data + out, in, literals);
+            in  += literals;
+            out += literals;
+
+            if (!getVarint(in, end, length)) return false;
+            if (length == 0) return out == xi_data_length;
+            if (!getVarint(in, end, offset) || (offset == 0) || (offset > out) || (length > xi_data_length - out)) return false;
+
+            // copy forward, byte by byte, since match might overlap itself
+            if (xo_data == nullptr) {
+                out += length;
+                continue;
+            }
+            for (std::uint64_t k{}; k < length; ++k, ++out) {
+                xo_data[out] = xo_data[out - offset];
+            }
+        }
+    }
+
+    // replace a tree with loaded collections (kept in the tree allocators)
+    template<typename T, class DataAllocator, class IndexAllocator>
+    void assignTree(FlatTree<T, DataAllocator, IndexAllocator>& xo_tree, std::vector<T>&& xi_values, std::vector<std::size_t>&& xi_parents) {
+        if constexpr (std::is_same_v<DataAllocator, std::allocator<T>> && std::is_same_v<IndexAllocator, std::allocator<std::size_t>>) {
+            xo_tree = FlatTree<T>(std::move(xi_values), std::move(xi_parents));
+        } else {
+            xo_tree = FlatTree<T, DataAllocator, IndexAllocator>(xi_values, xi_parents, xo_tree.dataAllocator(), xo_tree.indexAllocator());
+        }
+    }
+
+    // load a block compressed tree file (header was already read and validated), blocks are verified and decompressed in parallel.
+    // block table and blocks are verified against file length before node collections are allocated.
+    template<typename T, class DataAllocator, class IndexAllocator>
+    bool loadCompressed(const std::string& xi_path, const FileHeader& xi_header, FlatTree<T, DataAllocator, IndexAllocator>& xo_tree) {
+        const std::size_t len{ xi_header.size },
+                          nodes_per_block{ xi_header.reserved[0] };
+        if (nodes_per_block == 0) return false;
+        const std::size_t blocks{ len / nodes_per_block + ((len % nodes_per_block == 0) ? 0 : 1) };
+
+        // map file
+        const int fd{ ::open(xi_path.c_str(), O_RDONLY) };
+        if (fd < 0) return false;
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        const std::size_t file_length{ static_cast<std::size_t>(info.st_size) };
+        void* mapped{ ::mmap(nullptr, file_length, PROT_READ, MAP_PRIVATE, fd, 0) };
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        ::madvise(mapped, file_length, MADV_WILLNEED);
+        const std::uint8_t* file{ static_cast<const std::uint8_t*>(mapped) };
+
+        // block table (its length is bounded by file length, so it can not overflow)
+        bool succeed{ (file_length >= sizeof(FileHeader)) && (blocks <= (file_length - sizeof(FileHeader)) / (2 * sizeof(BlockEntry))) };
+        const std::size_t table_end{ succeed ? sizeof(FileHeader) + 2 * blocks * sizeof(BlockEntry) : 0 };
+        std::vector<BlockEntry> table(succeed ? 2 * blocks : 0);
+        if (succeed) std::memcpy(table.data(), file + sizeof(FileHeader), table.size() * sizeof(BlockEntry));
+        std::vector<std::size_t> ids(table.size());
+        std::iota(ids.begin(), ids.end(), 0);
+
+        // verify blocks lie within file, match their checksums and encode exactly the amount of nodes the header declares
+        succeed = succeed && std::all_of(std::execution::par, ids.begin(), ids.end(), [&](const std::size_t id) {
+            const BlockEntry& entry{ table[id] };
+            if ((entry.offset < table_end) || (entry.offset > file_length) || (entry.length > file_length - entry.offset) || (entry.length == 0)) return false;
+            const std::uint8_t* block{ file + entry.offset };
+            if (crc32(block, entry.length) != entry.checksum) return false;
+
+            const std::size_t count{ std::min(nodes_per_block, len - (id % blocks) * nodes_per_block) };
+            if (id >= blocks) return (count <= std::numeric_limits<std::size_t>::max() / sizeof(T)) && decodeBytes(block, entry.length, nullptr, count * sizeof(T));
+            const std::size_t width{ block[0] };
+            return (width <= 64) && ((width == 0) || (count <= (entry.length - 1) * 8 / width));
+        });
+
+        // decompress blocks
+        std::vector<std::size_t> parents(succeed ? len : 0);
+        std::vector<T> values(succeed ? len : 0);
+        succeed = succeed && std::all_of(std::execution::par, ids.begin(), ids.end(), [&](const std::size_t id) {
+            const BlockEntry& entry{ table[id] };
+            const std::uint8_t* block{ file + entry.offset };
+            const std::size_t first{ (id % blocks) * nodes_per_block },
+                              count{ std::min(nodes_per_block, len - first) };
+            return (id < blocks) ? decodeParents(block, entry.length, parents.data() + first, count) :
+                                   decodeBytes(block, entry.length, reinterpret_cast<std::uint8_t*>(values.data() + first), count * sizeof(T));
+        });
+        ::munmap(mapped, file_length);
+
+        if (!succeed || !isValidParents(parents)) return false;
+        assignTree(xo_tree, std::move(values), std::move(parents));
+        return true;
+    }
+
+#ifdef FLAT_TREE_IO_URING
+    // minimal io_uring interface (raw system calls) used for batched asynchronous reads
+    class UringReader {
+
+        // properties
+        private:
+            int m_ring{ -1 };                       // ring file descriptor
+            void* m_sq{ MAP_FAILED };               // submission queue ring
+            std::size_t m_sq_size{};
+            void* m_cq{ MAP_FAILED };               // completion queue ring (might be the same mapping as submission queue)
+            std::size_t m_cq_size{};
+            io_uring_sqe* m_sqes{ static_cast<io_uring_sqe*>(MAP_FAILED) }; // submission queue entries
+            std::size_t m_sqes_size{};
+            unsigned* m_sq_tail{};
+            unsigned* m_sq_mask{};
+            unsigned* m_sq_array{};
+            unsigned* m_cq_head{};
+            unsigned* m_cq_tail{};
+            unsigned* m_cq_mask{};
+            io_uring_cqe* m_cqes{};
+
+        // constructor
+        public:
+            UringReader() = default;
+            ~UringReader() {
+                if (m_sqes != MAP_FAILED)            ::munmap(m_sqes, m_sqes_size);
+                if ((m_cq != MAP_FAILED) && (m_cq != m_sq)) ::munmap(m_cq, m_cq_size);
+                if (m_sq != MAP_FAILED)              ::munmap(m_sq, m_sq_size);
+                if (m_ring >= 0)                     ::close(m_ring);
+            }
+
+            UringReader(const UringReader&)            = delete;
+            UringReader& operator=(const UringReader&) = delete;
+
+        // operations
+        public:
+
+            // setup ring with a given amount of entries, return false if io_uring is not available
+            bool open(const unsigned xi_entries) noexcept {
+                io_uring_params params{};
+                m_ring = static_cast<int>(::syscall(__NR_io_uring_setup, xi_entries, &params));
+                if (m_ring < 0) return false;
+
+                m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                const bool single{ (params.features & IORING_FEAT_SINGLE_MMAP) != 0 };
+                if (single) {
+                    m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+                }
+
+                m_sq = ::mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+                if (m_sq == MAP_FAILED) return false;
+                m_cq = single ? m_sq : ::mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+                if (m_cq == MAP_FAILED) return false;
+                m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+                m_sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES));
+                if (m_sqes == MAP_FAILED) return false;
+
+                char* sq{ static_cast<char*>(m_sq) };
+                char* cq{ static_cast<char*>(m_cq) };
+                m_sq_tail  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                m_sq_mask  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+                m_cq_head  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                m_cq_tail  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                m_cq_mask  = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                m_cqes     = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+                return true;
+            }
+
+            // submit a read request
+            bool read(const int xi_fd, void* xo_buffer, const unsigned xi_length, const std::uint64_t xi_offset, const std::uint64_t xi_tag) noexcept {
+                const unsigned tail{ *m_sq_tail },
+                               index{ tail & *m_sq_mask };
+                io_uring_sqe& sqe{ m_sqes[index] };
+                std::memset(&sqe, 0, sizeof(io_uring_sqe));
+                sqe.opcode    = IORING_OP_READ;
+                sqe.fd        = xi_fd;
+                sqe.addr      = reinterpret_cast<std::uint64_t>(xo_buffer);
+                sqe.len       = xi_length;
+                sqe.off       = xi_offset;
+                sqe.user_data = xi_tag;
+                m_sq_array[index] = index;
+                __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+                long submitted{};
+                do {
+                    submitted = ::syscall(__NR_io_uring_enter, m_ring, 1, 0, 0, nullptr, 0);
+                } while ((submitted < 0) && (errno == EINTR));
+                return submitted == 1;
+            }
+
+            // wait for a request completion, return its tag and result (amount of bytes read or negative error code)
+            bool wait(std::uint64_t& xo_tag, int& xo_result) noexcept {
+                for (;;) {
+                    const unsigned head{ *m_cq_head };
+                    if (head != __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+                        const io_uring_cqe& cqe{ m_cqes[head & *m_cq_mask] };
+                        xo_tag    = cqe.user_data;
+                        xo_result = cqe.res;
+                        __atomic_store_n(m_cq_head, head + 1, __ATOMIC_RELEASE);
+                        return true;
+                    }
+
+                    if ((::syscall(__NR_io_uring_enter, m_ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) && (errno != EINTR)) return false;
+                }
+            }
+    };
+#endif
+}
+
+namespace FlatTreeIO {
+
+    /**
+    * \brief save a tree to a file
+    *
+    * @param {FlatTree, in}  tree (node type must be trivially copyable)
+    * @param {string,   in}  file path
+    * @param {bool,     out} true if tree was saved, false otherwise
+    **/
+    template<typename T, class DataAllocator, class IndexAllocator>
+    bool save(FlatTree<T, DataAllocator, IndexAllocator>& xi_tree, const std::string& xi_path) {
+        static_assert(std::is_trivially_copyable_v<T>, "tree node type must be trivially copyable.");
+        std::string temporary;
+        if (!FlatTreeIODetail::makeTemporary(xi_path, temporary)) return false;
+        const T* values{ xi_tree.data() };
+        if (FlatTreeIODetail::writeImage(xi_path.c_str(), temporary.c_str(), xi_tree.parentData(), values, xi_tree.size())) return true;
+        ::unlink(temporary.c_str());
+        return false;
+    }
+
+    /**
+    * \brief save a tree to a block compressed file.
+    *        parent indices and node values are split into blocks of a given amount of nodes, each compressed independently
+    *        (in parallel) and protected by a checksum. parent indices are delta encoded and bit packed, node values are LZ compressed.
+    *
+    * @param {FlatTree, in}  tree (node type must be trivially copyable)
+    * @param {string,   in}  file path
+    * @param {size_t,   in}  amount of nodes in each block
+    * @param {bool,     out} true if tree was saved, false otherwise
+    **/
+    template<typename T, class DataAllocator, class IndexAllocator>
+    bool saveCompressed(FlatTree<T, DataAllocator, IndexAllocator>& xi_tree, const std::string& xi_path, const std::size_t xi_nodes_per_block = 1 << 16) {
+        static_assert(std::is_trivially_copyable_v<T>, "tree node type must be trivially copyable.");
+        using namespace FlatTreeIODetail;
+        assert(xi_nodes_per_block > 0 && " block must hold at least one node.");
+
+        const std::size_t len{ xi_tree.size() },
+                          blocks{ (len + xi_nodes_per_block - 1) / xi_nodes_per_block };
+        const T* values{ xi_tree.data() };
+        const std::size_t* parents{ xi_tree.parentData() };
+
+        // compress blocks (parent index blocks followed by node value blocks)
+        std::vector<std::vector<std::uint8_t>> encoded(2 * blocks);
+        std::vector<BlockEntry> table(2 * blocks);
+        std::vector<std::size_t> ids(2 * blocks);
+        std::iota(ids.begin(), ids.end(), 0);
+        std::for_each(std::execution::par, ids.begin(), ids.end(), [&](const std::size_t id) {
+            const std::size_t block{ id % blocks },
+                              first{ block * xi_nodes_per_block },
+                              count{ std::min(xi_nodes_per_block, len - first) };
+            if (id < blocks) encodeParents(parents + first, count, encoded[id]);
+            else             encodeBytes(reinterpret_cast<const std::uint8_t*>(values + first), count * sizeof(T), encoded[id]);
+            table[id].length   = encoded[id].size();
+            table[id].checksum = crc32(encoded[id].data(), encoded[id].size());
+        });
+
+        // layout
+        std::uint64_t offset{ sizeof(FileHeader) + table.size() * sizeof(BlockEntry) };
+        for (BlockEntry& entry : table) {
+            entry.offset = offset;
+            offset += entry.length;
+        }
+        FileHeader header{ makeHeader<T>(compressed_version, len) };
+        header.reserved[0] = xi_nodes_per_block;
+
+        // write (into a uniquely named temporary file, which is removed if writing fails)
+        std::string temporary;
+        if (!makeTemporary(xi_path, temporary)) return false;
+        const int fd{ ::open(temporary.c_str(), O_WRONLY | O_TRUNC) };
+        if (fd < 0) {
+            ::unlink(temporary.c_str());
+            return false;
+        }
+        bool written{ writeAll(fd, &header, sizeof(FileHeader)) && writeAll(fd, table.data(), table.size() * sizeof(BlockEntry)) };
+        for (std::size_t i{}; written && (i < encoded.size()); ++i) {
+            written = writeAll(fd, encoded[i].data(), encoded[i].size());
+        }
+        written = written && (::fsync(fd) == 0);
+        const bool closed{ ::close(fd) == 0 };
+
+        if (written && closed && (::rename(temporary.c_str(), xi_path.c_str()) == 0)) return true;
+        ::unlink(temporary.c_str());
+        return false;
+    }
+
+    /**
+    * \brief load a tree from a file
+    *
+    * @param {string,   in}  file path
+    * @param {FlatTree, out} loaded tree
+    * @param {bool,     out} true if tree was loaded, false otherwise (in which case output tree is not modified)
+    **/
+    template<typename T, class DataAllocator, class IndexAllocator>
+    bool load(const std::string& xi_path, FlatTree<T, DataAllocator, IndexAllocator>& xo_tree) {
+        static_assert(std::is_trivially_copyable_v<T>, "tree node type must be trivially copyable.");
+        using namespace FlatTreeIODetail;
+
+        const int fd{ ::open(xi_path.c_str(), O_RDONLY) };
+        if (fd < 0) return false;
+
+        FileHeader header{};
+        bool succeed{ readAll(fd, &header, sizeof(FileHeader)) && isValidHeader<T>(header) };
+        if (succeed && (header.version == compressed_version)) {
+            ::close(fd);
+            return loadCompressed(xi_path, header, xo_tree);
+        }
+        succeed = succeed && (header.version == raw_version) && isRawImageLength<T>(fd, header);
+        std::vector<std::size_t> parents;
+        std::vector<T> values;
+        if (succeed) {
+            parents.resize(header.size);
+            values.resize(header.size);
+            succeed = readAll(fd, parents.data(), header.size * sizeof(std::size_t)) &&
+                      readAll(fd, values.data(), header.size * sizeof(T));
+        }
+        ::close(fd);
+
+        if (!succeed || !isValidParents(parents)) return false;
+        assignTree(xo_tree, std::move(values), std::move(parents));
+        return true;
+    }
+
+    /**
+    * \brief load a tree from a file, overlapping storage access with decoding.
+    *        file is read in large aligned chunks (using O_DIRECT where file system allows it), several chunks are in flight
+    *        (submitted through io_uring where available) while a completed chunk is decoded into the tree collections.
+    *
+    * @param {string,   in}  file path
+    * @param {FlatTree, out} loaded tree
+    * @param {size_t,   in}  chunk size in bytes (rounded up to a multiple of 4096, and limited to 2GB)
+    * @param {unsigned, in}  amount of chunks in flight
+    * @param {bool,     out} true if tree was loaded, false otherwise (in which case output tree is not modified)
+    **/
+    template<typename T, class DataAllocator, class IndexAllocator>
+    bool loadOverlapped(const std::string& xi_path, FlatTree<T, DataAllocator, IndexAllocator>& xo_tree, std::size_t xi_chunk_size = 8 << 20, unsigned xi_queue_depth = 4) {
+        static_assert(std::is_trivially_copyable_v<T>, "tree node type must be trivially copyable.");
+        using namespace FlatTreeIODetail;
+        constexpr std::size_t block{ 4096 },
+                              max_chunk{ static_cast<std::size_t>(std::numeric_limits<int>::max()) & ~(block - 1) }; // a read request length is unsigned, and its completion result is an int
+        xi_chunk_size  = std::max(block, (std::min(xi_chunk_size, max_chunk) + block - 1) & ~(block - 1));
+        xi_queue_depth = std::max(1u, xi_queue_depth);
+
+        // header
+        FileHeader header{};
+        {
+            const int fd{ ::open(xi_path.c_str(), O_RDONLY) };
+            if (fd < 0) return false;
+            bool valid{ readAll(fd, &header, sizeof(FileHeader)) && isValidHeader<T>(header) };
+            if (valid && (header.version != raw_version)) {
+                ::close(fd);
+                return load(xi_path, xo_tree);
+            }
+            valid = valid && isRawImageLength<T>(fd, header);
+            ::close(fd);
+            if (!valid) return false;
+        }
+        const std::uint64_t parents_offset{ sizeof(FileHeader) },
+                            parents_length{ header.size * sizeof(std::size_t) },
+                            values_offset{ parents_offset + parents_length },
+                            values_length{ header.size * sizeof(T) },
+                            file_length{ values_offset + values_length };
+        xi_chunk_size = static_cast<std::size_t>(std::min<std::uint64_t>(xi_chunk_size, (file_length + block - 1) & ~std::uint64_t{ block - 1 }));
+        const std::size_t chunks{ static_cast<std::size_t>((file_length + xi_chunk_size - 1) / xi_chunk_size) };
+
+        // bulk reads bypass page cache where possible
+        int fd{ ::open(xi_path.c_str(), O_RDONLY | O_DIRECT) };
+        if (fd < 0) fd = ::open(xi_path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        std::vector<std::size_t> parents(header.size);
+        std::vector<T> values(header.size);
+        const auto decode = [&](const char* buffer, const std::size_t chunk, const std::size_t length) {
+            const std::uint64_t offset{ chunk * xi_chunk_size };
+            copyOverlap(buffer, offset, length, parents_offset, parents_length, parents.data());
+            copyOverlap(buffer, offset, length, values_offset, values_length, values.data());
+        };
+
+        // aligned chunk buffers
+        const std::size_t depth{ std::min<std::size_t>(xi_queue_depth, chunks) };
+        void* memory{ nullptr };
+        if (::posix_memalign(&memory, block, depth * xi_chunk_size) != 0) {
+            ::close(fd);
+            return false;
+        }
+        char* buffers{ static_cast<char*>(memory) };
+
+        // complete a (possibly short) read of a chunk
+        const auto completeChunk = [&](char* buffer, const std::size_t chunk, std::size_t received) -> bool {
+            const std::uint64_t offset{ chunk * xi_chunk_size };
+            const std::size_t expected{ static_cast<std::size_t>(std::min<std::uint64_t>(xi_chunk_size, file_length - offset)) };
+            while (received < expected) {
+                const ssize_t count{ ::pread(fd, buffer + received, xi_chunk_size - received, static_cast<off_t>(offset + received)) };
+                if (count <= 0) return false;
+                received += static_cast<std::size_t>(count);
+            }
+            decode(buffer, chunk, expected);
+            return true;
+        };
+
+        bool succeed{ true };
+        bool overlapped{ false };
+#ifdef FLAT_TREE_IO_URING
+        UringReader ring;
+        if (ring.open(static_cast<unsigned>(depth))) {
+            overlapped = true;
+
+            // keep 'depth' chunks in flight, chunk 'i' is read into buffer 'i % depth'
+            std::size_t next{},
+                        inflight{};
+            const auto submit = [&](char* buffer) {
+                if (!ring.read(fd, buffer, static_cast<unsigned>(xi_chunk_size), next * xi_chunk_size, next)) return false;
+                ++next;
+                ++inflight;
+                return true;
+            };
+            while (succeed && (next < depth)) {
+                succeed = submit(buffers + next * xi_chunk_size);
+            }
+            while (succeed && (inflight > 0)) {
+                std::uint64_t chunk{};
+                int result{};
+                if (!ring.wait(chunk, result)) break;
+                --inflight;
+
+                // decode completed chunk while the others are read, then reuse its buffer
+                char* buffer{ buffers + (chunk % depth) * xi_chunk_size };
+                succeed = (result >= 0) && completeChunk(buffer, chunk, static_cast<std::size_t>(result));
+                if (succeed && (next < chunks)) {
+                    succeed = submit(buffer);
+                }
+            }
+
+            // drain requests which are still in flight before releasing their buffers
+            std::uint64_t chunk{};
+            int result{};
+            while ((inflight > 0) && ring.wait(chunk, result)) {
+                --inflight;
+            }
+            succeed = succeed && (inflight == 0);
+        }
+#endif
+        // synchronous fallback
+        if (!overlapped) {
+            for (std::size_t chunk{}; succeed && (chunk < chunks); ++chunk) {
+                succeed = completeChunk(buffers, chunk, 0);
+            }
+        }
+
+        ::free(memory);
+        ::close(fd);
+
+        // O_DIRECT might be rejected at read time, in which case use a regular load
+        if (!succeed) return load(xi_path, xo_tree);
+        if (!isValidParents(parents)) return false;
+
+        assignTree(xo_tree, std::move(values), std::move(parents));
+        return true;
+    }
+
+    /**
+    * \brief write a point-in-time image of a tree to a file, without blocking tree modifications.
+    *        process is forked and the child process writes the tree as it was at fork time (memory pages are shared copy-on-write,
+    *        so only pages modified while the snapshot is written are duplicated). a detached thread waits for the child process,
+    *        so dropping the returned future does not block. image is written to a uniquely named temporary file which then
+    *        replaces the target, so concurrent snapshots of the same target do not collide.
+    *        tree can be modified as soon as this function returns.
+    *        allocators whose storage is shared across processes (see 'MappedFileAllocator') are rejected, since their pages
+    *        are not copy-on-write, i.e. - the child would observe modifications (and releases) performed while it writes.
+    *
+    * @param {FlatTree,     in}  tree (node type must be trivially copyable)
+    * @param {string,       in}  file path
+    * @param {future<bool>, out} becomes ready (true if snapshot was written, false otherwise) once snapshot is written
+    **/
+    template<typename T, class DataAllocator, class IndexAllocator>
+    std::future<bool> snapshot(FlatTree<T, DataAllocator, IndexAllocator>& xi_tree, const std::string& xi_path) {
+        static_assert(std::is_trivially_copyable_v<T>, "tree node type must be trivially copyable.");
+        static_assert(!FlatTreeIODetail::is_shared_mapping_v<DataAllocator> && !FlatTreeIODetail::is_shared_mapping_v<IndexAllocator>,
+                      "snapshot requires copy-on-write (process private) tree storage.");
+
+        auto result = std::make_shared<std::promise<bool>>();
+        std::future<bool> xo_written{ result->get_future() };
+
+        // everything the child needs is prepared before forking (child performs no allocation)
+        std::string path{ xi_path },
+                    temporary;
+        if (!FlatTreeIODetail::makeTemporary(xi_path, temporary)) {
+            result->set_value(false);
+            return xo_written;
+        }
+        const T* values{ xi_tree.data() };
+        const std::size_t* parents{ xi_tree.parentData() };
+        const std::size_t len{ xi_tree.size() };
+
+        const pid_t pid{ ::fork() };
+        if (pid == 0) {
+            const bool written{ FlatTreeIODetail::writeImage(path.c_str(), temporary.c_str(), parents, values, len) };
+            ::_exit(written ? 0 : 1);
+        }
+        if (pid < 0) {
+            ::unlink(temporary.c_str());
+            result->set_value(false);
+            return xo_written;
+        }
+
+        std::thread([pid, result, temporary = std::move(temporary)]() {
+            int status{};
+            bool written{ true };
+            while (::waitpid(pid, &status, 0) < 0) {
+                if (errno != EINTR) {
+                    written = false;
+                    break;
+                }
+            }
+            written = written && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+            if (!written) ::unlink(temporary.c_str());
+            result->set_value(written);
+        }).detach();
+
+        return xo_written;
+    }
+}
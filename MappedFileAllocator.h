@@ -0,0 +1,112 @@
+/**
+* File backed allocator for trees larger than physical memory.
+*
+* Dan Israel Malta
+**/
+#pragma once
+#include <string>
+#include <memory>
+#include <new>
+#include <cstdint>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "FlatTree.h"
+
+/**
+* \brief an allocator whose every allocation is a shared memory mapping of a sparse, unlinked, temporary file.
+*        mapped pages are backed by the file (rather than swap), so containers using it (such as FlatTree collections)
+*        can grow beyond physical memory, while file blocks are only allocated for pages which were actually written.
+*        allocator also accepts access pattern hints (see 'advise'), which FlatTree issues according to its running operation.
+*
+*        notice that growth is not performed in place (using 'mremap' on a single backing file): a std::vector relocates its
+*        elements from the old allocation into the new one, so both must be alive (and distinct) at the same time.
+*        every reallocation therefore maps a fresh file and copies all elements, briefly holding both mappings,
+*        i.e. - amortized O(1) per insertion (geometric growth), but peak (sparse) file usage during growth is three times the capacity before it.
+*        reserve capacity up front (see 'FlatTree::reserve') when the final tree size is known.
+*
+* @param {T, in} allocated object type
+**/
+template<typename T> class MappedFileAllocator {
+
+    // properties
+    private:
+        std::shared_ptr<const std::string> m_directory; // directory in which backing files are created
+
+    // member types
+    public:
+        using value_type        = T;
+        using is_shared_mapping = std::true_type;   // storage is shared (not copy-on-write) across forked processes (see FlatTreeIO::snapshot)
+
+    // constructor
+    public:
+
+        // @param {string, in} directory in which (unlinked) backing files are created
+        explicit MappedFileAllocator(const std::string& xi_directory = "/tmp") : m_directory(std::make_shared<const std::string>(xi_directory)) {}
+
+        template<typename U> MappedFileAllocator(const MappedFileAllocator<U>& xi_other) noexcept : m_directory(xi_other.directory()) {}
+
+    // allocation
+    public:
+
+        // allocate (a mapping of a sparse file able to hold) 'xi_count' objects
+        T* allocate(const std::size_t xi_count) {
+            const std::size_t length{ mappedLength(xi_count) };
+
+            std::string path{ *m_directory + "/flat_tree_XXXXXX" };
+            const int fd{ ::mkstemp(path.data()) };
+            if (fd < 0) throw std::bad_alloc();
+            ::unlink(path.c_str());
+
+            void* mapped{ MAP_FAILED };
+            if (::ftruncate(fd, static_cast<off_t>(length)) == 0) {
+                mapped = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+            }
+            ::close(fd);
+            if (mapped == MAP_FAILED) throw std::bad_alloc();
+
+            return static_cast<T*>(mapped);
+        }
+
+        // release an allocation (its backing file is removed once unmapped)
+        void deallocate(T* xi_pointer, const std::size_t xi_count) noexcept {
+            ::munmap(xi_pointer, mappedLength(xi_count));
+        }
+
+        /**
+        * \brief hint the kernel about the expected access pattern of an allocated range
+        *
+        * @param {void*,         in} range start (within an allocation)
+        * @param {size_t,        in} range length [bytes]
+        * @param {AccessPattern, in} expected access pattern
+        **/
+        void advise(const void* xi_pointer, const std::size_t xi_length, const AccessPattern xi_pattern) const noexcept {
+            if ((xi_pointer == nullptr) || (xi_length == 0)) return;
+
+            const std::uintptr_t page{ static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE)) },
+                                 first{ reinterpret_cast<std::uintptr_t>(xi_pointer) & ~(page - 1) },
+                                 last{ reinterpret_cast<std::uintptr_t>(xi_pointer) + xi_length };
+            const int advice{ (xi_pattern == AccessPattern::Sequential) ? MADV_SEQUENTIAL :
+                              (xi_pattern == AccessPattern::Random)     ? MADV_RANDOM     : MADV_NORMAL };
+            ::madvise(reinterpret_cast<void*>(first), last - first, advice);
+        }
+
+        // return directory in which backing files are created
+        inline const std::shared_ptr<const std::string>& directory() const noexcept { return m_directory; }
+
+    // operators
+    public:
+
+        template<typename U> friend bool operator==(const MappedFileAllocator& xi_a, const MappedFileAllocator<U>& xi_b) noexcept { return *xi_a.m_directory == *xi_b.directory(); }
+        template<typename U> friend bool operator!=(const MappedFileAllocator& xi_a, const MappedFileAllocator<U>& xi_b) noexcept { return !(xi_a == xi_b); }
+
+    // internal methods
+    private:
+
+        // mapping length (whole pages) of a given amount of objects
+        static std::size_t mappedLength(const std::size_t xi_count) noexcept {
+            const std::size_t page{ static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) },
+                              bytes{ xi_count * sizeof(T) };
+            return ((bytes == 0 ? 1 : bytes) + page - 1) & ~(page - 1);
+        }
+};
@@ -0,0 +1,370 @@
+/**
+* Flat tree published in a POSIX shared memory segment.
+*
+* Dan Israel Malta
+**/
+#pragma once
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "FlatTree.h"
+
+namespace SharedFlatTreeDetail {
+
+    // segment header. all arrays are addressed by their offset from segment start, so segment is position independent.
+    struct Header {
+        std::uint64_t magic;                    // segment identifier
+        std::uint64_t value_size;               // sizeof(T)
+        std::uint64_t capacity;                 // maximal amount of nodes
+        std::uint64_t segment_size;             // segment size (in bytes)
+        std::uint64_t data_offset;              // offset of node values (capacity values)
+        std::uint64_t parent_offset;            // offset of nodes parent index (capacity indices)
+        std::uint64_t child_offset_offset;      // offset of compressed first generation descendants index offsets (capacity + 1 indices)
+        std::uint64_t children_offset;          // offset of compressed first generation descendants index (capacity indices)
+        std::atomic<std::uint64_t> sequence;    // publication sequence, odd while writer publishes
+        std::atomic<std::uint64_t> size;        // amount of nodes in tree
+    };
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared segment requires lock free atomics.");
+
+    inline constexpr std::uint64_t magic{ 0x45455254544c4646 }; // "FFLTTREE"
+    inline constexpr std::uint64_t alignment{ 64 };
+
+    inline constexpr std::uint64_t align(const std::uint64_t xi_offset) noexcept {
+        return (xi_offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    // spin wait hint
+    inline void pause() noexcept {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_ia32_pause();
+#endif
+    }
+
+    // return pointer to an array located at a given offset
+    template<typename U> inline U* at(void* xi_segment, const std::uint64_t xi_offset) noexcept {
+        return reinterpret_cast<U*>(static_cast<char*>(xi_segment) + xi_offset);
+    }
+    template<typename U> inline const U* at(const void* xi_segment, const std::uint64_t xi_offset) noexcept {
+        return reinterpret_cast<const U*>(static_cast<const char*>(xi_segment) + xi_offset);
+    }
+}
+
+/**
+* \brief writer side of a flat tree published in a POSIX shared memory segment.
+*        a single writer process creates the segment and publishes trees into it, readers (see SharedFlatTreeReader) map it read-only.
+*        besides node values and parent indices, segment holds a first generation descendants index, so readers need no indexing of their own.
+*
+* @param {T, in} tree node type (must be trivially copyable)
+**/
+template<typename T> class SharedFlatTreeWriter {
+    static_assert(std::is_trivially_copyable_v<T>, "shared tree node type must be trivially copyable.");
+
+    // properties
+    private:
+        std::string m_name;                     // segment name
+        void* m_segment{ nullptr };             // mapped segment
+        std::size_t m_segment_size{};           // mapped segment size
+
+    // constructor
+    public:
+        SharedFlatTreeWriter() = default;
+        ~SharedFlatTreeWriter() { close(); }
+
+        SharedFlatTreeWriter(const SharedFlatTreeWriter&)            = delete;
+        SharedFlatTreeWriter& operator=(const SharedFlatTreeWriter&) = delete;
+
+    // segment management
+    public:
+
+        /**
+        * \brief create a shared memory segment able to hold a tree of a given amount of nodes.
+        *        an existing segment of the same name is never reused (readers might still map it, and resizing it would fault their reads),
+        *        so a stale segment must be removed first (see 'remove'), after which readers which still map it keep their (old) segment.
+        *
+        * @param {string, in}  segment name (as in shm_open, i.e. - "/name")
+        * @param {size_t, in}  maximal amount of nodes
+        * @param {bool,   out} true if segment was created, false otherwise (including when a segment of that name exists)
+        **/
+        bool create(const std::string& xi_name, const std::size_t xi_capacity) {
+            using namespace SharedFlatTreeDetail;
+            close();
+
+            // layout
+            Header header{};
+            header.magic               = magic;
+            header.value_size          = sizeof(T);
+            header.capacity            = xi_capacity;
+            header.data_offset         = align(sizeof(Header));
+            header.parent_offset       = align(header.data_offset + xi_capacity * sizeof(T));
+            header.child_offset_offset = align(header.parent_offset + xi_capacity * sizeof(std::uint64_t));
+            header.children_offset     = align(header.child_offset_offset + (xi_capacity + 1) * sizeof(std::uint64_t));
+            header.segment_size        = align(header.children_offset + xi_capacity * sizeof(std::uint64_t));
+
+            // create and map
+            const int fd{ ::shm_open(xi_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644) };
+            if (fd < 0) return false;
+            if (::ftruncate(fd, static_cast<off_t>(header.segment_size)) != 0) {
+                ::close(fd);
+                ::shm_unlink(xi_name.c_str());
+                return false;
+            }
+            void* segment{ ::mmap(nullptr, header.segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) };
+            ::close(fd);
+            if (segment == MAP_FAILED) {
+                ::shm_unlink(xi_name.c_str());
+                return false;
+            }
+
+            // initialize header (an empty tree)
+            Header* shared{ new (segment) Header{} };
+            shared->magic               = header.magic;
+            shared->value_size          = header.value_size;
+            shared->capacity            = header.capacity;
+            shared->segment_size        = header.segment_size;
+            shared->data_offset         = header.data_offset;
+            shared->parent_offset       = header.parent_offset;
+            shared->child_offset_offset = header.child_offset_offset;
+            shared->children_offset     = header.children_offset;
+            shared->sequence.store(0, std::memory_order_release);
+            shared->size.store(0, std::memory_order_release);
+
+            m_name         = xi_name;
+            m_segment      = segment;
+            m_segment_size = header.segment_size;
+            return true;
+        }
+
+        // unmap segment (segment remains available for readers)
+        void close() noexcept {
+            if (m_segment != nullptr) ::munmap(m_segment, m_segment_size);
+            m_segment      = nullptr;
+            m_segment_size = 0;
+        }
+
+        // remove segment name (mapped segments remain valid until unmapped)
+        bool unlink() noexcept {
+            return !m_name.empty() && (::shm_unlink(m_name.c_str()) == 0);
+        }
+
+        // remove a segment name, e.g. - one left by a previous writer (mapped segments remain valid until unmapped)
+        static bool remove(const std::string& xi_name) noexcept {
+            return ::shm_unlink(xi_name.c_str()) == 0;
+        }
+
+    // publication
+    public:
+
+        /**
+        * \brief publish a tree into the segment. readers using 'SharedFlatTreeReader::read' never observe a partially published tree.
+        *
+        * @param {FlatTree, in}  tree to publish
+        * @param {bool,     out} true if tree was published, false otherwise (segment is not created or tree exceeds its capacity)
+        **/
+        template<class DataAllocator, class IndexAllocator>
+        bool publish(FlatTree<T, DataAllocator, IndexAllocator>& xi_tree) {
+            using namespace SharedFlatTreeDetail;
+            if (m_segment == nullptr) return false;
+
+            Header* header{ static_cast<Header*>(m_segment) };
+            const std::size_t len{ xi_tree.size() };
+            if (len > header->capacity) return false;
+
+            T* data{ at<T>(m_segment, header->data_offset) };
+            std::uint64_t* parent{ at<std::uint64_t>(m_segment, header->parent_offset) };
+            std::uint64_t* offset{ at<std::uint64_t>(m_segment, header->child_offset_offset) };
+            std::uint64_t* children{ at<std::uint64_t>(m_segment, header->children_offset) };
+
+            // open publication
+            header->sequence.fetch_add(1, std::memory_order_acq_rel);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            // values and parents
+            std::copy(xi_tree.cbegin(), xi_tree.cend(), data);
+            parent[0] = 0;
+            for (std::size_t i{ 1 }; i < len; ++i) {
+                parent[i] = xi_tree.getParentIndex(i);
+            }
+
+            // first generation descendants index
+            std::fill(offset, offset + len + 1, 0);
+            for (std::size_t i{ 1 }; i < len; ++i) {
+                ++offset[parent[i] + 1];
+            }
+            for (std::size_t i{}; i < len; ++i) {
+                offset[i + 1] += offset[i];
+            }
+            std::vector<std::uint64_t> cursor(offset, offset + len);
+            for (std::size_t i{ 1 }; i < len; ++i) {
+                children[cursor[parent[i]]++] = i;
+            }
+
+            // close publication
+            header->size.store(len, std::memory_order_relaxed);
+            header->sequence.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+};
+
+/**
+* \brief reader side of a flat tree published in a POSIX shared memory segment (see SharedFlatTreeWriter).
+*        segment is mapped read-only and queried in place, without copying.
+*
+* @param {T, in} tree node type (must be trivially copyable)
+**/
+template<typename T> class SharedFlatTreeReader {
+    static_assert(std::is_trivially_copyable_v<T>, "shared tree node type must be trivially copyable.");
+
+    // properties
+    private:
+        const void* m_segment{ nullptr };                   // mapped segment
+        std::size_t m_segment_size{};                       // mapped segment size
+        const SharedFlatTreeDetail::Header* m_header{};     // segment header
+        const T* m_data{};                                  // node values
+        const std::uint64_t* m_parent_index{};              // nodes parent index
+        const std::uint64_t* m_child_offset{};              // first generation descendants of node 'i' are m_children[m_child_offset[i]] ... m_children[m_child_offset[i + 1] - 1]
+        const std::uint64_t* m_children{};                  // first generation descendants, grouped by parent
+
+    // constructor
+    public:
+        SharedFlatTreeReader() = default;
+        ~SharedFlatTreeReader() { close(); }
+
+        SharedFlatTreeReader(const SharedFlatTreeReader&)            = delete;
+        SharedFlatTreeReader& operator=(const SharedFlatTreeReader&) = delete;
+
+    // segment management
+    public:
+
+        /**
+        * \brief map an existing shared memory segment (read-only)
+        *
+        * @param {string, in}  segment name (as in shm_open, i.e. - "/name")
+        * @param {bool,   out} true if segment was mapped, false otherwise
+        **/
+        bool open(const std::string& xi_name) {
+            using namespace SharedFlatTreeDetail;
+            close();
+
+            const int fd{ ::shm_open(xi_name.c_str(), O_RDONLY, 0) };
+            if (fd < 0) return false;
+            struct stat info {};
+            if ((::fstat(fd, &info) != 0) || (static_cast<std::size_t>(info.st_size) < sizeof(Header))) {
+                ::close(fd);
+                return false;
+            }
+            const std::size_t segment_size{ static_cast<std::size_t>(info.st_size) };
+            const void* segment{ ::mmap(nullptr, segment_size, PROT_READ, MAP_SHARED, fd, 0) };
+            ::close(fd);
+            if (segment == MAP_FAILED) return false;
+
+            const Header* header{ static_cast<const Header*>(segment) };
+            if ((header->magic != magic) || (header->value_size != sizeof(T)) || (header->segment_size > segment_size)) {
+                ::munmap(const_cast<void*>(segment), segment_size);
+                return false;
+            }
+
+            m_segment      = segment;
+            m_segment_size = segment_size;
+            m_header       = header;
+            m_data         = at<T>(segment, header->data_offset);
+            m_parent_index = at<std::uint64_t>(segment, header->parent_offset);
+            m_child_offset = at<std::uint64_t>(segment, header->child_offset_offset);
+            m_children     = at<std::uint64_t>(segment, header->children_offset);
+            return true;
+        }
+
+        // unmap segment
+        void close() noexcept {
+            if (m_segment != nullptr) ::munmap(const_cast<void*>(m_segment), m_segment_size);
+            m_segment = nullptr;
+            m_header  = nullptr;
+        }
+
+        /**
+        * \brief perform a consistent read of the published tree, i.e. - invoke a function on this reader until it
+        *        completes without the writer publishing concurrently (function might be invoked more than once).
+        *        while writer publishes, reader spins (with a pause hint) and then yields; if no consistent read completes
+        *        within a given time (e.g. - writer died while publishing), read fails.
+        *
+        * @param {function, in}  operation to be performed on reader (const SharedFlatTreeReader& -> void)
+        * @param {duration, in}  maximal time to wait for a consistent read
+        * @param {bool,     out} true if function completed a consistent read, false if it timed out
+        **/
+        template<class FUNC> bool read(FUNC&& xi_func, const std::chrono::microseconds xi_timeout = std::chrono::seconds(1)) const {
+            assert(m_header != nullptr && " segment is not mapped.");
+            constexpr std::size_t spins{ 64 };
+            const auto deadline{ std::chrono::steady_clock::now() + xi_timeout };
+            for (std::size_t attempt{};; ++attempt) {
+                if (attempt >= spins) {
+                    if (std::chrono::steady_clock::now() >= deadline) return false;
+                    std::this_thread::yield();
+                } else if (attempt > 0) {
+                    SharedFlatTreeDetail::pause();
+                }
+
+                const std::uint64_t before{ m_header->sequence.load(std::memory_order_acquire) };
+                if (before & 1) continue;
+
+                xi_func(*this);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_header->sequence.load(std::memory_order_relaxed) == before) return true;
+            }
+        }
+
+    // queries
+    public:
+
+        // return amount of nodes in published tree
+        inline std::size_t size() const noexcept { return (m_header != nullptr) ? m_header->size.load(std::memory_order_acquire) : 0; }
+
+        // return publication sequence (changes whenever writer publishes a tree)
+        inline std::uint64_t sequence() const noexcept { return (m_header != nullptr) ? m_header->sequence.load(std::memory_order_acquire) : 0; }
+
+        // iterate over node values
+        inline const T* begin() const noexcept { return m_data;          }
+        inline const T* end()   const noexcept { return m_data + size(); }
+
+        // get node at a given index
+        const T& operator[](const std::size_t xi_index) const { assert(xi_index < size()); return m_data[xi_index]; }
+
+        // given a node (by its index), return its parent index
+        inline std::size_t getParentIndex(const std::size_t xi_index) const {
+            assert(xi_index < size() && " node index is invalid");
+            return m_parent_index[xi_index];
+        }
+
+        // given node (given by its index), return the amount of first generation descendants
+        inline std::size_t getNumOfDescendants(const std::size_t xi_parent_index) const {
+            assert(xi_parent_index < size() && " node index is invalid");
+            return m_child_offset[xi_parent_index + 1] - m_child_offset[xi_parent_index];
+        }
+
+        /**
+        * \brief given node (given by its index), return a list of all its first generation descendants nodes
+        *
+        * @param {size_t,             in}  parent index
+        * @param {collection<size_t>, out} collection holding descendants nodes
+        * @param {bool,               out} true if node has descendants, false otherwise
+        **/
+        template<typename C> bool getDescendants(const std::size_t xi_parent_index, C& xo_descendants) const {
+            assert(xi_parent_index < size() && " node index is invalid");
+            const std::uint64_t first{ m_child_offset[xi_parent_index] },
+                                last{ m_child_offset[xi_parent_index + 1] };
+            for (std::uint64_t k{ first }; k < last; ++k) {
+                xo_descendants.emplace_back(static_cast<std::size_t>(m_children[k]));
+            }
+            return first != last;
+        }
+};
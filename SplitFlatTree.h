@@ -0,0 +1,171 @@
+/**
+* Flat tree with hot/cold node field splitting.
+*
+* Dan Israel Malta
+**/
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <execution>
+#include <assert.h>
+#include "FlatTree.h"
+
+/**
+* \brief node of a split tree - hot fields are stored inline, cold fields are stored in an arena and referenced by position.
+*
+* @param {HOT, in} hot fields type
+**/
+template<typename HOT> struct SplitNode {
+    HOT hot{};              // hot (frequently accessed) fields
+    std::size_t cold{};     // position of node cold fields in cold arena
+};
+
+/**
+* \brief a flat tree whose nodes are split to hot and cold fields.
+*        hot fields (along with a handle to the cold fields) are stored contiguously in the tree, so traversals and
+*        structural operations touch only them. cold fields are stored in a separate arena and are fetched on demand.
+*        structural operations (sort, reorder, relayout) move only the compact node handles, arena can later be laid out
+*        in tree order using 'compactCold'.
+*
+* @param {HOT,  in} hot fields type
+* @param {COLD, in} cold fields type
+**/
+template<typename HOT, typename COLD> class SplitFlatTree {
+
+    // properties
+    private:
+        static constexpr std::size_t size_for_parallelization{ 2'000 }; // above this number of tree nodes, certain operations shall be parallelized
+        FlatTree<SplitNode<HOT>> m_tree;                                // tree of hot fields and cold field handles
+        std::vector<COLD> m_cold;                                       // cold fields arena
+        std::vector<std::size_t> m_free;                                // released arena positions
+
+    // constructor
+    public:
+
+        // basic constructor (a tree which only has a root)
+        SplitFlatTree(HOT xi_hot, COLD xi_cold) : m_tree(SplitNode<HOT>{ std::move(xi_hot), 0 }) {
+            m_cold.emplace_back(std::move(xi_cold));
+        }
+
+        // construct from collections of hot fields, cold fields and parent indices (all of equal size)
+        SplitFlatTree(std::vector<HOT>&& xi_hot, std::vector<COLD>&& xi_cold, std::vector<std::size_t>&& xi_parent_index) :
+            m_tree(splitNodes(std::move(xi_hot)), std::move(xi_parent_index)), m_cold(std::move(xi_cold)) {
+            assert(m_cold.size() == m_tree.size() && " SplitFlatTree input collections are not of equal size.");
+        }
+
+    // queries
+    public:
+
+        // return amount of nodes in tree
+        inline std::size_t size() const noexcept { return m_tree.size(); }
+
+        // given a node (by its index), return its parent index
+        inline std::size_t getParentIndex(const std::size_t xi_index) { return m_tree.getParentIndex(xi_index); }
+
+        // get/change hot fields of a node (given by its index)
+        const HOT  hot(const std::size_t xi_index) const { assert(xi_index < size()); return m_tree[xi_index].hot; }
+              HOT& hot(const std::size_t xi_index)       { assert(xi_index < size()); return m_tree[xi_index].hot; }
+
+        // get/change cold fields of a node (given by its index)
+        const COLD& cold(const std::size_t xi_index) const { assert(xi_index < size()); return m_cold[m_tree[xi_index].cold]; }
+              COLD& cold(const std::size_t xi_index)       { assert(xi_index < size()); return m_cold[m_tree[xi_index].cold]; }
+
+        // underlying tree (of hot fields and cold field handles), for structural queries and operations.
+        // notice that nodes removed through it do not release their cold fields until 'compactCold' is called.
+        inline FlatTree<SplitNode<HOT>>& tree() noexcept { return m_tree; }
+
+    // modifiers
+    public:
+
+        /**
+        * \brief add a node to a given parent
+        *
+        * @param {size_t, in}  parent index
+        * @param {HOT,    in}  node hot fields
+        * @param {COLD,   in}  node cold fields
+        * @param {bool,   out} true if operation is successful
+        **/
+        bool insert(const std::size_t xi_parent_id, HOT xi_hot, COLD xi_cold) {
+            if (xi_parent_id >= size()) return false;
+
+            // place cold fields (reuse released positions), position is taken only once node was inserted
+            const bool reuse{ !m_free.empty() };
+            const std::size_t position{ reuse ? m_free.back() : m_cold.size() };
+            if (!m_tree.insert(xi_parent_id, SplitNode<HOT>{ std::move(xi_hot), position })) return false;
+
+            if (reuse) {
+                m_free.pop_back();
+                m_cold[position] = std::move(xi_cold);
+            } else {
+                m_cold.emplace_back(std::move(xi_cold));
+            }
+            return true;
+        }
+
+        /**
+        * \brief remove all descendants of a node (given by its index), releasing their cold fields.
+        *        since removal relocates nodes, released positions are those which were held before removal
+        *        and are no longer referenced by any remaining node.
+        *
+        * @param {size_t, in}  node index
+        * @param {bool,   out} true if operation was successful, false otherwise
+        **/
+        bool remove(const std::size_t xi_index) {
+            // positions held before removal
+            std::vector<bool> held(m_cold.size(), false);
+            for (std::size_t i{}; i < size(); ++i) {
+                held[m_tree.data()[i].cold] = true;
+            }
+
+            if (!m_tree.remove(xi_index)) return false;
+
+            // release positions no longer referenced
+            for (std::size_t i{}; i < size(); ++i) {
+                held[m_tree.data()[i].cold] = false;
+            }
+            for (std::size_t position{}; position < held.size(); ++position) {
+                if (held[position]) m_free.emplace_back(position);
+            }
+            return true;
+        }
+
+        /**
+        * \brief apply an operation on the hot fields of all descendants of a given node (given by its index) using a given execution policy.
+        *        cold fields are not touched.
+        *
+        * @param {size_t,   in} index of node from which traversal is performed
+        * @param {executer, in} execution policy
+        * @param {function, in} operation to be performed on descendants hot fields (HOT&)
+        **/
+        template<class EXECUTER, class FUNC> void traverseHot(const std::size_t xi_index, EXECUTER&& xi_exec, FUNC&& xi_func) {
+            m_tree.Traverse(xi_index, std::forward<EXECUTER>(xi_exec), [f = std::forward<FUNC>(xi_func)](SplitNode<HOT>& node) mutable {
+                f(node.hot);
+            });
+        }
+
+        // lay out cold fields arena in tree order (nodes cold fields are gathered in parallel for large trees), dropping released positions
+        void compactCold() {
+            const std::size_t len{ size() };
+            SplitNode<HOT>* nodes{ m_tree.data() };
+            std::vector<COLD> cold(len);
+
+            FlatTreeDetail::forEachIndex(len, size_for_parallelization, [this, &cold, nodes](const std::size_t i) {
+                cold[i]       = std::move(m_cold[nodes[i].cold]);
+                nodes[i].cold = i;
+            });
+
+            m_cold = std::move(cold);
+            m_free.clear();
+        }
+
+    // internal methods
+    private:
+
+        static std::vector<SplitNode<HOT>> splitNodes(std::vector<HOT>&& xi_hot) {
+            std::vector<SplitNode<HOT>> nodes(xi_hot.size());
+            for (std::size_t i{}; i < nodes.size(); ++i) {
+                nodes[i] = SplitNode<HOT>{ std::move(xi_hot[i]), i };
+            }
+            return nodes;
+        }
+};
@@ -0,0 +1,154 @@
+/**
+* Value columns sharing one immutable tree structure.
+*
+* Dan Israel Malta
+**/
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <execution>
+#include <type_traits>
+#include <assert.h>
+#include "FlatTree.h"
+
+/**
+* \brief immutable tree structure (parent index of each node), meant to be shared (via std::shared_ptr) by several value columns.
+*        root is the node located at index 0.
+**/
+class TreeTopology {
+
+    // properties
+    private:
+        const std::vector<std::size_t> m_parent_index; // collection holding tree nodes parent index
+
+    // constructor
+    public:
+
+        // construct from a parent index collection
+        explicit TreeTopology(std::vector<std::size_t>&& xi_parent_index) : m_parent_index(std::move(xi_parent_index)) {
+            assert(!m_parent_index.empty() && (m_parent_index[0] == 0) && " root node must be the first node in tree.");
+        }
+
+        // construct from a tree (an object with 'size' and 'getParentIndex' methods, such as FlatTree)
+        template<class TREE, typename std::enable_if<!std::is_same_v<std::decay_t<TREE>, TreeTopology>>::type* = nullptr>
+        explicit TreeTopology(TREE& xi_tree) : m_parent_index(parentsOf(xi_tree)) {}
+
+        // topology is immutable and shared, not copied
+        TreeTopology(const TreeTopology&)            = delete;
+        TreeTopology& operator=(const TreeTopology&) = delete;
+
+    // queries
+    public:
+
+        // return amount of nodes in tree
+        inline std::size_t size() const noexcept { return m_parent_index.size(); }
+
+        // given a node (by its index), return its parent index
+        inline std::size_t getParentIndex(const std::size_t xi_index) const {
+            assert(xi_index < m_parent_index.size() && " node index is invalid");
+            return m_parent_index[xi_index];
+        }
+
+        // iterate over nodes parent index
+        auto begin() const noexcept -> decltype(m_parent_index.cbegin()) { return m_parent_index.cbegin(); }
+        auto end()   const noexcept -> decltype(m_parent_index.cend())   { return m_parent_index.cend();   }
+
+    // internal methods
+    private:
+
+        template<class TREE> static std::vector<std::size_t> parentsOf(TREE& xi_tree) {
+            std::vector<std::size_t> parents(xi_tree.size());
+            for (std::size_t i{ 1 }; i < parents.size(); ++i) {
+                parents[i] = xi_tree.getParentIndex(i);
+            }
+            return parents;
+        }
+};
+
+/**
+* \brief a collection of node values bound to a shared tree structure.
+*        several columns (of various value types) can be bound to the same topology without copying it.
+*
+* @param {T, in} node value type
+**/
+template<typename T> class TreeColumn {
+
+    // properties
+    private:
+        static constexpr std::size_t size_for_parallelization{ 2'000 }; // above this number of tree nodes, certain operations shall be parallelized
+        std::shared_ptr<const TreeTopology> m_topology;                 // tree structure
+        std::vector<T> m_data;                                          // collection holding tree node values
+
+    // member types
+    public:
+        using value_type = T;
+
+    // constructor
+    public:
+
+        // bind a collection of values to a topology
+        TreeColumn(std::shared_ptr<const TreeTopology> xi_topology, std::vector<T>&& xi_data) : m_topology(std::move(xi_topology)), m_data(std::move(xi_data)) {
+            assert(m_topology && (m_topology->size() == m_data.size()) && " column size does not match topology size.");
+        }
+
+        // bind a default valued column to a topology
+        explicit TreeColumn(std::shared_ptr<const TreeTopology> xi_topology) : m_topology(std::move(xi_topology)) {
+            assert(m_topology && " column must be bound to a topology.");
+            m_data.resize(m_topology->size());
+        }
+
+        // create a column (and its topology) from a FlatTree
+        template<class DataAllocator, class IndexAllocator>
+        explicit TreeColumn(FlatTree<T, DataAllocator, IndexAllocator>& xi_tree) : m_topology(std::make_shared<const TreeTopology>(xi_tree)), m_data(xi_tree.begin(), xi_tree.end()) {}
+
+    // iterators (allow iteration on all column values)
+    public:
+
+        auto begin()  noexcept -> decltype(m_data.begin())  { return m_data.begin();  }
+        auto cbegin() noexcept -> decltype(m_data.cbegin()) { return m_data.cbegin(); }
+        auto end()    noexcept -> decltype(m_data.end())    { return m_data.end();    }
+        auto cend()   noexcept -> decltype(m_data.cend())   { return m_data.cend();   }
+
+    // queries
+    public:
+
+        // return amount of nodes in column
+        inline std::size_t size() const noexcept { return m_data.size(); }
+
+        // return column topology
+        inline const std::shared_ptr<const TreeTopology>& topology() const noexcept { return m_topology; }
+
+        // given a node (by its index), return its parent index
+        inline std::size_t getParentIndex(const std::size_t xi_index) const { return m_topology->getParentIndex(xi_index); }
+
+        // get/change node value at a given index
+        const T& operator[](const std::size_t xi_index) const { assert(xi_index < size()); return m_data[xi_index]; }
+              T& operator[](const std::size_t xi_index)       { assert(xi_index < size()); return m_data[xi_index]; }
+
+        // return a FlatTree holding a copy of this column values and its structure
+        FlatTree<T> toFlatTree() const {
+            return FlatTree<T>(m_data, std::vector<std::size_t>(m_topology->begin(), m_topology->end()));
+        }
+
+    // operations
+    public:
+
+        /**
+        * \brief create a new column, bound to the same topology, by applying a function on each node value.
+        *        function is applied in parallel for large columns.
+        *
+        * @param {function,      in}  operation to be performed on each node value (const T& -> U)
+        * @param {TreeColumn<U>, out} new column
+        **/
+        template<class FUNC, typename U = std::decay_t<std::invoke_result_t<FUNC, const T&>>>
+        TreeColumn<U> transform(FUNC&& xi_func) const {
+            std::vector<U> data(m_data.size());
+            if (m_data.size() < size_for_parallelization) {
+                std::transform(std::execution::seq, m_data.begin(), m_data.end(), data.begin(), std::forward<FUNC>(xi_func));
+            } else {
+                std::transform(std::execution::par, m_data.begin(), m_data.end(), data.begin(), std::forward<FUNC>(xi_func));
+            }
+            return TreeColumn<U>(m_topology, std::move(data));
+        }
+};
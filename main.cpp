@@ -1,9 +1,18 @@
 #include "FlatTree.h"
+#include "CentroidIndex.h"
+#include "TreeColumn.h"
+#include "SharedFlatTree.h"
+#include "FlatTreeIO.h"
+#include "FlatTreeArrow.h"
+#include "SplitFlatTree.h"
+#include "MappedFileAllocator.h"
+#include "ExternalTree.h"
 #include <string.h>
 #include <algorithm>
 #include <array>
 #include <list>
 #include <iostream>
+#include <atomic>
 
 void constructionTest() {
 
@@ -122,9 +131,967 @@ void traverseTreeTest() {
     std::cout << "tree (multimap dump): \n"; a.dumpToConsoleMultiMap(); std::cout << "\n";
 }
 
+void sortChildrenTest() {
+    // create tree
+    FlatTree<std::string> a({ "root", "b", "a", "b2", "b1", "a2", "a1", "a3" },
+                            {   0,     0,   0,   1,    1,    2,    2,    2});
+
+    // sort by name
+    a.sortChildren([](const std::string& node) { return node; });
+    std::cout << "tree after sorting (simple dump): \n"; a.dumpToConsoleSimple(); std::cout << "\n";
+
+    std::vector<std::string> sorted{ "root", "a", "b", "a1", "a2", "a3", "b1", "b2" };
+    std::for_each(a.begin(), a.end(), [&, i = 0](const auto& elm) mutable {
+        assert(elm.compare(sorted[i]) == 0);
+        ++i;
+    });
+    assert(a.getParentIndex(5) == 1);
+    assert(a.getParentIndex(6) == 2);
+
+    // binary search descendants
+    std::size_t index{};
+    assert(a.findChild(2, std::string("b1"), [](const std::string& node) { return node; }, index) == true);
+    assert(index == 6);
+    assert(a.findChild(1, std::string("b1"), [](const std::string& node) { return node; }, index) == false);
+}
+
+void distanceTest() {
+    // create tree
+    FlatTree<std::string> a({ "root", "child1", "child2", "grand child 0", "grand child 1", "grand child 2", "grand child 3", "grand child 4" },
+                            {   0,      0,         0,       1,                  1,             1,                 2,                 2});
+
+    assert(a.getDepth(0) == 0);
+    assert(a.getDepth(6) == 2);
+    assert(a.getLowestCommonAncestor(3, 5) == 1);
+    assert(a.getLowestCommonAncestor(3, 7) == 0);
+    assert(a.getLowestCommonAncestor(3, 1) == 1);
+
+    assert(a.distance(3, 3) == 0);
+    assert(a.distance(3, 5) == 2);
+    assert(a.distance(3, 7) == 4);
+    assert(a.distance(0, 7) == 2);
+
+    // bulk distance queries
+    std::vector<std::pair<std::size_t, std::size_t>> pairs{ {3, 7}, {0, 7}, {3, 5}, {1, 3} };
+    std::vector<std::size_t> distances;
+    a.distance(pairs, distances);
+    assert((distances == std::vector<std::size_t>{ 4, 2, 2, 1 }));
+
+    // structural index is updated after modification
+    a << std::make_pair(7, "grand grand child 0");
+    assert(a.distance(3, 8) == 5);
+}
+
+void centroidIndexTest() {
+    // create tree
+    FlatTree<std::string> a({ "root", "child1", "child2", "grand child 0", "grand child 1", "grand child 2", "grand child 3", "grand child 4" },
+                            {   0,      0,         0,       1,                  1,             1,                 2,                 2});
+    CentroidIndex index(a);
+
+    std::size_t node{}, distance{};
+    assert(index.nearestMarked(3, node, distance) == false);
+
+    index.mark(7);
+    assert(index.nearestMarked(3, node, distance) == true);
+    assert((node == 7) && (distance == 4));
+
+    index.mark(2);
+    assert(index.nearestMarked(3, node, distance) == true);
+    assert((node == 2) && (distance == 3));
+
+    index.mark(5);
+    assert(index.nearestMarked(3, node, distance) == true);
+    assert((node == 5) && (distance == 2));
+
+    index.unmark(5);
+    assert(index.nearestMarked(3, node, distance) == true);
+    assert((node == 2) && (distance == 3));
+    assert(index.isMarked(5) == false);
+}
+
+void virtualTreeTest() {
+    // create tree
+    FlatTree<std::string> a({ "root", "child1", "child2", "grand child 0", "grand child 1", "grand child 2", "grand child 3", "grand child 4" },
+                            {   0,      0,         0,       1,                  1,             1,                 2,                 2});
+
+    // virtual tree of "grand child 0", "grand child 2" and "grand child 4" is {root -> {child1 -> {grand child 0, grand child 2}, grand child 4}}
+    FlatTree<std::size_t> v{ a.buildVirtualTree(std::vector<std::size_t>{ 7, 3, 5 }) };
+    std::cout << "virtual tree (simple dump): \n"; v.dumpToConsoleSimple(); std::cout << "\n";
+
+    assert(v.size() == 5);
+    assert((v[0] == 0) && (v[1] == 1) && (v[2] == 3) && (v[3] == 5) && (v[4] == 7));
+    assert(v.getParentIndex(1) == 0);
+    assert(v.getParentIndex(2) == 1);
+    assert(v.getParentIndex(3) == 1);
+    assert(v.getParentIndex(4) == 0);
+
+    // virtual tree of nodes in one sub-tree is rooted at their lowest common ancestor
+    FlatTree<std::size_t> w{ a.buildVirtualTree(std::vector<std::size_t>{ 4, 5 }) };
+    assert(w.size() == 3);
+    assert((w[0] == 1) && (w[1] == 4) && (w[2] == 5));
+}
+
+void treeColumnTest() {
+    // create tree
+    FlatTree<std::string> a({ "root", "child1", "child2", "grand child 0", "grand child 1", "grand child 2", "grand child 3", "grand child 4" },
+                            {   0,      0,         0,       1,                  1,             1,                 2,                 2});
+
+    // labels column and derived columns sharing its structure
+    TreeColumn<std::string> labels(a);
+    TreeColumn<std::size_t> lengths{ labels.transform([](const std::string& label) { return label.size(); }) };
+    TreeColumn<char>        flags{ labels.topology() };
+
+    assert(lengths.topology() == labels.topology());
+    assert(flags.topology() == labels.topology());
+    assert(labels.topology().use_count() == 3);
+
+    assert(lengths.size() == 8);
+    assert(lengths[0] == 4);
+    assert(lengths[3] == 13);
+    assert(lengths.getParentIndex(7) == 2);
+    assert(flags[5] == 0);
+
+    // back to a tree
+    FlatTree<std::size_t> b{ lengths.toFlatTree() };
+    assert(b.size() == 8);
+    assert(b.getParentIndex(5) == 1);
+    assert(b[1] == 6);
+}
+
+void filterTest() {
+    // create tree
+    FlatTree<std::string> a({ "root", "child1", "child2", "grand child 0", "grand child 1", "grand child 2", "grand child 3", "grand child 4" },
+                            {   0,      0,         0,       1,                  1,             1,                 2,                 2});
+    const auto notChild2 = [](const std::string& node) { return node.compare("child2") != 0; };
+
+    // prune "child2" sub-tree
+    FlatTree<std::string> pruned{ a.filter(notChild2, FilterMode::Prune) };
+    std::cout << "pruned tree (simple dump): \n"; pruned.dumpToConsoleSimple(); std::cout << "\n";
+    assert(pruned.size() == 5);
+    assert(pruned[4].compare("grand child 2") == 0);
+    assert(pruned.getParentIndex(4) == 1);
+
+    // lift "child2" descendants to root
+    FlatTree<std::string> lifted{ a.filter(notChild2, FilterMode::Lift) };
+    std::cout << "lifted tree (simple dump): \n"; lifted.dumpToConsoleSimple(); std::cout << "\n";
+    assert(lifted.size() == 7);
+    assert(lifted[5].compare("grand child 3") == 0);
+    assert(lifted.getParentIndex(5) == 0);
+    assert(lifted.getParentIndex(6) == 0);
+    assert(lifted.getParentIndex(3) == 1);
+
+    // large (parallel) lift of odd nodes in a binary tree
+    constexpr std::size_t len{ 10'000 };
+    std::vector<int> values(len);
+    std::vector<std::size_t> parents(len);
+    for (std::size_t i{}; i < len; ++i) {
+        values[i]  = static_cast<int>(i);
+        parents[i] = i / 2;
+    }
+    FlatTree<int> b(values, parents, std::allocator<int>{}, std::allocator<std::size_t>{});
+    FlatTree<int> even{ b.filter([](const int node) { return node % 2 == 0; }, FilterMode::Lift) };
+    assert(even.size() == len / 2);
+    for (std::size_t i{}; i < even.size(); ++i) {
+        assert(even[i] == static_cast<int>(2 * i));
+    }
+    assert(even.getParentIndex(2) == 1);    // node 4 keeps its parent (node 2)
+    assert(even.getParentIndex(3) == 0);    // node 6 ancestors (3 and 1) are lifted, so it hangs on root
+}
+
+void pathEnumerationTest() {
+    // create tree
+    FlatTree<std::string> a({ "root", "child1", "child2", "grand child 0", "grand child 1", "grand child 2", "grand child 3", "grand child 4" },
+                            {   0,      0,         0,       1,                  1,             1,                 2,                 2});
+
+    // enumerate paths sequentially
+    std::vector<std::vector<std::size_t>> paths;
+    a.forEachPath(std::execution::seq, [&paths](const std::vector<std::size_t>& path) {
+        paths.push_back(path);
+    });
+    assert(paths.size() == 5);
+    assert((paths[0] == std::vector<std::size_t>{ 0, 1, 3 }));
+    assert((paths[4] == std::vector<std::size_t>{ 0, 2, 7 }));
+
+    // enumerate paths in parallel
+    std::atomic<std::size_t> length{};
+    a.forEachPath(std::execution::par, [&length](const std::vector<std::size_t>& path) {
+        length += path.size();
+    });
+    assert(length == 15);
+
+    // star shaped tree - a single path buffer is used for all paths
+    FlatTree<int> b(0);
+    b.insert(0, std::vector<int>(100, 1));
+    std::vector<const std::size_t*> buffers;
+    b.forEachPath(std::execution::seq, [&buffers](const std::vector<std::size_t>& path) {
+        assert(path.size() == 2);
+        buffers.push_back(path.data());
+    });
+    assert(buffers.size() == 100);
+    assert(std::all_of(buffers.begin(), buffers.end(), [first = buffers[0]](const std::size_t* buffer) { return buffer == first; }));
+}
+
+void ancestorTest() {
+    // create tree
+    FlatTree<std::string> a({ "root", "child1", "child2", "grand child 0", "grand child 1", "grand child 2", "grand child 3", "grand child 4" },
+                            {   0,      0,         0,       1,                  1,             1,                 2,                 2});
+
+    assert(a.isAncestor(0, 7) == true);
+    assert(a.isAncestor(2, 7) == true);
+    assert(a.isAncestor(7, 7) == true);
+    assert(a.isAncestor(1, 7) == false);
+    assert(a.isAncestor(7, 2) == false);
+
+    // test against many candidates
+    std::vector<std::uint8_t> results;
+    assert(a.isAncestor(std::vector<std::size_t>{ 1, 3, 2, 0 }, 6, results) == true);
+    assert((results == std::vector<std::uint8_t>{ 0, 0, 1, 1 }));
+    assert(a.isAncestor(std::vector<std::size_t>{ 1, 3 }, 6, results) == false);
+
+    // numbering is recomputed after structural modification
+    a << std::make_pair(3, "grand grand child 0");
+    assert(a.isAncestor(1, 8) == true);
+    assert(a.isAncestor(2, 8) == false);
+}
+
+void subtreeUpdateTest() {
+    // create tree
+    FlatTree<int> a({ 0, 10, 20, 30, 40, 50, 60, 70 },
+                    { 0, 0,  0,  1,  1,  1,  2,  2 });
+
+    // shift "child1" sub-tree, disable "child2" sub-tree, and shift everything
+    a.subtreeAdd(1, 1);
+    a.subtreeAssign(2, -1);
+    a.subtreeAdd(0, 100);
+
+    // lazy read
+    assert(a.pointRead(0) == 100);
+    assert(a.pointRead(4) == 141);
+    assert(a.pointRead(7) == 99);
+
+    // values are materialized once iterated
+    std::vector<int> expected{ 100, 111, 99, 131, 141, 151, 99, 99 };
+    std::for_each(a.begin(), a.end(), [&, i = 0](const auto& elm) mutable {
+        assert(elm == expected[i]);
+        ++i;
+    });
+
+    // large (parallel) materialization of a chain
+    constexpr std::size_t len{ 10'000 };
+    std::vector<int> values(len, 0);
+    std::vector<std::size_t> parents(len);
+    for (std::size_t i{ 1 }; i < len; ++i) parents[i] = i - 1;
+    FlatTree<int> b(values, parents, std::allocator<int>{}, std::allocator<std::size_t>{});
+    b.subtreeAdd(len / 2, 7);
+    const int* nodes{ b.data() };
+    for (std::size_t i{}; i < len; ++i) {
+        assert(nodes[i] == ((i < len / 2) ? 0 : 7));
+    }
+}
+
+void sharedTreeTest() {
+    // create tree
+    FlatTree<int> a({ 0, 10, 20, 30, 40, 50, 60, 70 },
+                    { 0, 0,  0,  1,  1,  1,  2,  2 });
+
+    // publish tree
+    const std::string name{ "/flat_tree_test_" + std::to_string(::getpid()) };
+    SharedFlatTreeWriter<int> writer;
+    assert(writer.create(name, 16) == true);
+    assert(writer.publish(a) == true);
+
+    // an existing segment is never re-created
+    SharedFlatTreeWriter<int> other;
+    assert(other.create(name, 4) == false);
+
+    // query it (usually from another process)
+    SharedFlatTreeReader<int> reader;
+    assert(reader.open(name) == true);
+    const bool consistent = reader.read([](const SharedFlatTreeReader<int>& tree) {
+        assert(tree.size() == 8);
+        assert(tree[3] == 30);
+        assert(tree.getParentIndex(7) == 2);
+        assert(tree.getNumOfDescendants(1) == 3);
+
+        std::vector<std::size_t> kids;
+        assert(tree.getDescendants(2, kids) == true);
+        assert((kids == std::vector<std::size_t>{ 6, 7 }));
+    });
+    assert(consistent == true);
+
+    // publish an update
+    a << std::make_pair(7, 80);
+    assert(writer.publish(a) == true);
+    assert(reader.size() == 9);
+    assert(reader.getParentIndex(8) == 7);
+
+    // a writer which died while publishing does not block readers forever
+    {
+        const int fd{ ::shm_open(name.c_str(), O_RDWR, 0) };
+        assert(fd >= 0);
+        void* segment{ ::mmap(nullptr, sizeof(SharedFlatTreeDetail::Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) };
+        ::close(fd);
+        assert(segment != MAP_FAILED);
+        auto& sequence = static_cast<SharedFlatTreeDetail::Header*>(segment)->sequence;
+        sequence.fetch_add(1);
+        assert(reader.read([](const SharedFlatTreeReader<int>&) {}, std::chrono::milliseconds(10)) == false);
+        sequence.fetch_add(1);
+        assert(reader.read([](const SharedFlatTreeReader<int>&) {}) == true);
+        ::munmap(segment, sizeof(SharedFlatTreeDetail::Header));
+    }
+
+    assert(writer.unlink() == true);
+    assert(SharedFlatTreeWriter<int>::remove(name) == false);
+}
+
+void joinTest() {
+    // two versions of a catalog
+    FlatTree<std::string> a({ "catalog", "books", "music", "fiction", "poetry", "jazz" },
+                            { 0,         0,       0,       1,         1,        2 });
+    FlatTree<std::string> b({ "catalog", "music", "games", "books", "jazz", "rock", "poetry" },
+                            { 0,         0,       0,       0,       1,      1,      3 });
+
+    // match by key path
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    a.join(b, [](const std::string& node) { return node; }, pairs);
+    std::sort(pairs.begin(), pairs.end());
+    assert(pairs.size() == 5);
+    assert(pairs[0] == std::make_pair(std::size_t{ 0 }, std::size_t{ 0 }));
+    assert(pairs[1] == std::make_pair(std::size_t{ 1 }, std::size_t{ 3 }));
+    assert(pairs[2] == std::make_pair(std::size_t{ 2 }, std::size_t{ 1 }));
+    assert(pairs[3] == std::make_pair(std::size_t{ 4 }, std::size_t{ 6 }));
+    assert(pairs[4] == std::make_pair(std::size_t{ 5 }, std::size_t{ 4 }));
+}
+
+void attributeTest() {
+    // create tree
+    FlatTree<int> a({ 1, 2, 3, 4, 5, 6 },
+                    { 0, 0, 0, 1, 1, 2 });
+    std::size_t derivations{};
+
+    // path sum (depends on ancestors) and sub-tree sum (depends on descendants)
+    const auto path = a.registerAttribute<int>(AttributeDependency::Ancestors, [&derivations](const int& node, const std::vector<const int*>& parent) {
+        ++derivations;
+        return node + (parent.empty() ? 0 : *parent[0]);
+    });
+    const auto total = a.registerAttribute<int>(AttributeDependency::Descendants, [&derivations](const int& node, const std::vector<const int*>& children) {
+        ++derivations;
+        int sum{ node };
+        for (const int* child : children) sum += *child;
+        return sum;
+    });
+    assert(a.attribute(path, 4) == 8);
+    assert(a.attribute(total, 0) == 21);
+    assert(derivations == 9);
+
+    // cached
+    derivations = 0;
+    assert(a.attribute(path, 4) == 8);
+    assert(a.attribute(total, 1) == 11);
+    assert(derivations == 0);
+
+    // value write invalidates node sub-tree (path) and node ancestors (total)
+    a.set(1, 12);
+    assert(a.attribute(path, 3) == 17);
+    assert(a.attribute(total, 0) == 31);
+    assert(a.attribute(total, 2) == 9);
+    assert(derivations == 4);
+
+    // insertion
+    a.insert(5, 10);
+    assert(a.attribute(path, 6) == 20);
+    assert(a.attribute(total, 0) == 41);
+
+    // in place modification
+    a[6] = 0;
+    a.touch(6);
+    assert(a.attribute(total, 2) == 9);
+}
+
+void bestFirstTest() {
+    // create tree
+    FlatTree<int> a({ 5, 9, 1, 7, 3, 8, 2 },
+                    { 0, 0, 0, 1, 1, 2, 2 });
+
+    // visit in descending score order, only expanding visited nodes
+    std::vector<std::size_t> visited;
+    a.traverseBestFirst(0, [](const int node) { return node; }, [&visited](const std::size_t i, const double) {
+        visited.emplace_back(i);
+        return true;
+    });
+    assert((visited == std::vector<std::size_t>{ 0, 1, 3, 4, 2, 5, 6 }));
+
+    // early termination (top 3)
+    visited.clear();
+    a.traverseBestFirst(0, [](const int node) { return node; }, [&visited](const std::size_t i, const double) {
+        visited.emplace_back(i);
+        return visited.size() < 3;
+    });
+    assert((visited == std::vector<std::size_t>{ 0, 1, 3 }));
+
+    // score bound prunes low scoring nodes along with their sub-trees
+    visited.clear();
+    a.traverseBestFirst(0, [](const int node) { return node; }, [&visited](const std::size_t i, const double) {
+        visited.emplace_back(i);
+        return true;
+    }, 4.0);
+    assert((visited == std::vector<std::size_t>{ 0, 1, 3 }));
+
+    // nested traversal (of "child2" sub-tree) from within a visitor does not disturb the outer traversal
+    visited.clear();
+    std::vector<std::size_t> nested;
+    a.traverseBestFirst(0, [](const int node) { return node; }, [&](const std::size_t i, const double) {
+        visited.emplace_back(i);
+        if (i == 1) {
+            a.traverseBestFirst(2, [](const int node) { return node; }, [&nested](const std::size_t j, const double) {
+                nested.emplace_back(j);
+                return true;
+            });
+        }
+        return true;
+    });
+    assert((visited == std::vector<std::size_t>{ 0, 1, 3, 4, 2, 5, 6 }));
+    assert((nested == std::vector<std::size_t>{ 2, 5, 6 }));
+}
+
+void reorderTest() {
+    // create tree
+    FlatTree<std::string> a({ "root", "child1", "child2", "grand child 0", "grand child 1" },
+                            { 0,      0,        0,        1,               2 });
+
+    // out of place
+    std::vector<std::size_t> inverse;
+    assert(a.reorder({ 0, 4, 3, 2, 1 }, inverse) == true);
+    assert((inverse == std::vector<std::size_t>{ 0, 4, 3, 2, 1 }));
+    assert(a[1] == "grand child 1");
+    assert(a.getParentIndex(1) == 3);
+    assert(a.getParentIndex(2) == 4);
+
+    // in place (cycle following), back to original layout
+    const std::vector<std::size_t> back{ inverse };
+    assert(a.reorder(back, inverse, ReorderMode::InPlace) == true);
+    assert(a[3] == "grand child 0");
+    assert(a.getParentIndex(3) == 1);
+    assert(a.getParentIndex(4) == 2);
+
+    // invalid permutations
+    assert(a.reorder({ 1, 0, 2, 3, 4 }, inverse) == false);
+    assert(a.reorder({ 0, 1, 1, 3, 4 }, inverse) == false);
+    assert(a.reorder({ 0, 1, 2 }, inverse) == false);
+    assert(a[1] == "child1");
+
+    // large (parallel) out of place relocation of a binary tree
+    constexpr std::size_t len{ 10'000 };
+    std::vector<int> values(len);
+    std::vector<std::size_t> parents(len), order(len);
+    for (std::size_t i{}; i < len; ++i) {
+        values[i]  = static_cast<int>(i);
+        parents[i] = i / 2;
+        order[i]   = (i == 0) ? 0 : len - i;
+    }
+    FlatTree<int> b(values, parents, std::allocator<int>{}, std::allocator<std::size_t>{});
+    assert(b.reorder(order, inverse) == true);
+    for (std::size_t i{}; i < len; ++i) {
+        assert(b[i] == static_cast<int>(order[i]));
+        assert(b.getParentIndex(i) == inverse[order[i] / 2]);
+    }
+}
+
+void heatRelayoutTest() {
+    // create tree
+    FlatTree<int> a({ 0, 1, 2, 3, 4, 5, 6, 7 },
+                    { 0, 0, 0, 1, 1, 2, 2, 6 });
+
+    // count every access
+    a.setAccessProfiling(true, 1);
+    for (std::size_t i{}; i < 10; ++i) {
+        [[maybe_unused]] const int hot{ a[7] };
+    }
+    [[maybe_unused]] const int warm{ a[4] };
+    a.setAccessProfiling(false);
+    assert(a.getAccessCount(7) == 10);
+    assert(a.getAccessCount(4) == 1);
+    assert(a.getAccessCount(3) == 0);
+
+    // hottest node and its ancestors chain are packed at the front, followed by the rest in their relative order
+    std::vector<std::size_t> inverse;
+    a.relayoutByHeat(inverse, 0.1);
+    assert((inverse == std::vector<std::size_t>{ 0, 4, 1, 5, 6, 7, 2, 3 }));
+    assert(a[3] == 7);
+    assert(a.getParentIndex(3) == 2);
+    assert(a.getParentIndex(2) == 1);
+    assert(a.getAccessCount(3) == 10);
+}
+
+void splitTreeTest() {
+    // create tree (hot fields are node weights, cold fields are descriptions)
+    SplitFlatTree<int, std::string> a({ 1, 2, 3, 4 }, { "root", "child1", "child2", "grand child" }, { 0, 0, 0, 1 });
+    assert(a.size() == 4);
+    assert(a.hot(3) == 4);
+    assert(a.cold(3) == "grand child");
+
+    // traverse only hot fields
+    a.traverseHot(0, std::execution::seq, [](int& weight) { weight *= 10; });
+    assert(a.hot(2) == 30);
+    assert(a.cold(2) == "child2");
+
+    // removed descendants cold fields are reused
+    assert(a.remove(1) == true);
+    assert(a.size() == 3);
+    assert(a.insert(2, 50, "new grand child") == true);
+    assert(a.hot(3) == 50);
+    assert(a.cold(3) == "new grand child");
+
+    // structural operations move only hot fields and handles
+    a.tree().sortChildren([](const SplitNode<int>& node) { return -node.hot; });
+    assert(a.hot(1) == 30);
+    assert(a.cold(1) == "child2");
+    a.compactCold();
+    assert(a.cold(1) == "child2");
+    assert(a.cold(3) == "new grand child");
+
+    // removed sub-tree which is not at the end of the tree (remaining nodes are relocated)
+    SplitFlatTree<int, std::string> b({ 0, 1, 2, 3, 4, 5 }, { "r", "a", "b", "b1", "a1", "b2" }, { 0, 0, 0, 2, 1, 2 });
+    assert(b.remove(2) == true);
+    assert(b.size() == 4);
+    assert(b.hot(3) == 4);
+    assert(b.cold(3) == "a1");
+    assert(b.getParentIndex(3) == 1);
+    assert(b.insert(0, 6, "new1") == true);
+    assert(b.insert(0, 7, "new2") == true);
+    assert(b.cold(3) == "a1");
+    assert(b.cold(4) == "new1");
+    assert(b.cold(5) == "new2");
+    assert(b.cold(1) == "a");
+
+    // failed insertion does not take a position
+    assert(b.insert(17, 8, "invalid") == false);
+    assert(b.insert(3, 9, "a11") == true);
+    assert(b.cold(6) == "a11");
+    assert(b.cold(3) == "a1");
+
+    // large (parallel) compaction after reversing the root children order
+    constexpr std::size_t len{ 10'000 };
+    std::vector<int> hot(len);
+    std::vector<std::string> cold(len);
+    std::vector<std::size_t> parents(len, 0);
+    for (std::size_t i{}; i < len; ++i) {
+        hot[i]  = static_cast<int>(i);
+        cold[i] = std::to_string(i);
+    }
+    SplitFlatTree<int, std::string> c(std::move(hot), std::move(cold), std::move(parents));
+    c.tree().sortChildren([](const SplitNode<int>& node) { return -node.hot; });
+    c.compactCold();
+    for (std::size_t i{ 1 }; i < len; ++i) {
+        assert(c.tree()[i].cold == i);
+        assert(c.cold(i) == std::to_string(c.hot(i)));
+    }
+}
+
+// an allocator which records the access pattern hints it was given
+template<typename T> struct AdviceRecordingAllocator : std::allocator<T> {
+    using value_type = T;
+    template<typename U> struct rebind { using other = AdviceRecordingAllocator<U>; };
+    static inline std::vector<AccessPattern> hints;
+
+    AdviceRecordingAllocator() = default;
+    template<typename U> AdviceRecordingAllocator(const AdviceRecordingAllocator<U>&) noexcept {}
+    void advise(const void*, std::size_t, const AccessPattern xi_pattern) const { hints.emplace_back(xi_pattern); }
+};
+
+// an allocator which records the tag of every instance which allocated memory
+template<typename T> struct TaggedAllocator : std::allocator<T> {
+    using value_type = T;
+    template<typename U> struct rebind { using other = TaggedAllocator<U>; };
+    static inline std::vector<int> tags;
+    int tag{};
+
+    TaggedAllocator() = default;
+    explicit TaggedAllocator(const int xi_tag) noexcept : tag(xi_tag) {}
+    template<typename U> TaggedAllocator(const TaggedAllocator<U>& xi_other) noexcept : tag(xi_other.tag) {}
+    T* allocate(const std::size_t xi_count) { tags.emplace_back(tag); return std::allocator<T>::allocate(xi_count); }
+    template<typename U> bool operator==(const TaggedAllocator<U>& xi_other) const noexcept { return tag == xi_other.tag; }
+    template<typename U> bool operator!=(const TaggedAllocator<U>& xi_other) const noexcept { return tag != xi_other.tag; }
+};
+
+void mappedTreeTest() {
+    // file backed tree
+    using MappedTree = FlatTree<long, MappedFileAllocator<long>, MappedFileAllocator<std::size_t>>;
+    MappedTree a(0L);
+    for (long i{ 1 }; i < 10'000; ++i) {
+        assert(a.insert(static_cast<std::size_t>((i - 1) / 4), long{ i }) == true);
+    }
+    a.Traverse(0, std::execution::par, [](long& node) { node *= 2; });
+    assert(a.size() == 10'000);
+    assert(a[9'999] == 19'998);
+    assert(a.getParentIndex(9'999) == 2'499);
+
+    // access pattern hints follow running operation (and are not repeated)
+    FlatTree<int, AdviceRecordingAllocator<int>> b(0);
+    b.insert(0, std::vector<int>{ 1, 2 });
+    b.insert(1, 3);
+    const std::vector<AccessPattern>& hints{ AdviceRecordingAllocator<int>::hints };
+    std::vector<std::size_t> kids;
+    assert(b.getDescendants(0, kids) == false);
+    assert(b.getDescendants(1, kids) == true);
+    assert((hints == std::vector<AccessPattern>{ AccessPattern::Sequential }));
+    b.Traverse(1, std::execution::seq, [](int& node) { ++node; });
+    assert((hints == std::vector<AccessPattern>{ AccessPattern::Sequential, AccessPattern::Random }));
+
+    // given allocator instances are used for all storage the tree builds
+    using TaggedTree = FlatTree<int, TaggedAllocator<int>, TaggedAllocator<std::size_t>>;
+    TaggedTree c(0, TaggedAllocator<int>(7), TaggedAllocator<std::size_t>(7));
+    c.insert(0, std::vector<int>{ 1, 2, 3 });
+    c.insert(2, 4);
+    std::vector<std::size_t> inverse;
+    assert(c.reorder({ 0, 3, 2, 1, 4 }, inverse) == true);
+    TaggedTree d{ c.filter([](const int node) { return node != 2; }, FilterMode::Prune) };
+    assert(d.size() == 3);
+    const std::vector<int>& tags{ TaggedAllocator<int>::tags };
+    assert(!tags.empty() && std::all_of(tags.begin(), tags.end(), [](const int tag) { return tag == 7; }));
+
+    // mapped tree in a given directory
+    MappedTree e(0L, MappedFileAllocator<long>("/tmp"), MappedFileAllocator<std::size_t>("/tmp"));
+    e.insert(0, std::vector<long>{ 1, 2 });
+    MappedTree f{ e.filter([](const long node) { return node != 1; }, FilterMode::Prune) };
+    assert(f.size() == 2);
+    assert(f[1] == 2);
+}
+
+void traversalBufferTest() {
+    // create tree
+    FlatTree<int> a({ 0, 1, 2, 3, 4, 5, 6, 7 },
+                    { 0, 0, 7, 0, 1, 3, 1, 1 });
+
+    // descendants are gathered into a caller provided buffer and visited in memory order
+    std::vector<std::size_t> scratch;
+    std::vector<int> visited;
+    a.Traverse(1, std::execution::seq, [&visited](int& v) { visited.push_back(v); }, scratch, GatherOrder::Sorted);
+    assert((visited == std::vector<int>{ 2, 4, 6, 7 }));
+    assert((scratch == std::vector<std::size_t>{ 2, 4, 6, 7 }));
+
+    // nested traversals (each using its own buffer), with and without prefetching
+    for (const std::size_t distance : { 0, 2 }) {
+        a.setPrefetchDistance(distance);
+        std::size_t count{};
+        a.Traverse(0, std::execution::seq, [&a, &count](int& v) {
+            if (v == 1) a.Traverse(1, std::execution::seq, [&count](int&) { ++count; });
+            ++count;
+        });
+        assert(count == 11);
+    }
+
+    // deep chain
+    FlatTree<int> b(0);
+    for (std::size_t i{}; i < 10'000; ++i) {
+        b.insert(i, static_cast<int>(i + 1));
+    }
+    std::size_t sum{};
+    b.Traverse(1, std::execution::seq, [&sum](int& v) { sum += v; });
+    assert(sum == 10'000 * 10'001 / 2 - 1);
+}
+
+void batchQueryTest() {
+    // create tree
+    FlatTree<int> a({ 0, 1, 2, 3, 4, 5, 6, 7 },
+                    { 0, 0, 7, 0, 1, 3, 1, 1 });
+
+    // amount of first generation descendants of several nodes (might repeat)
+    std::vector<std::size_t> counts;
+    assert(a.getNumOfDescendants({ 1, 0, 2, 7, 1 }, counts) == true);
+    assert((counts == std::vector<std::size_t>{ 3, 2, 0, 1, 3 }));
+
+    // first generation descendants of several nodes (compressed)
+    std::vector<std::size_t> offset,
+                             descendants;
+    assert(a.getDescendants({ 3, 1, 2, 0 }, offset, descendants) == true);
+    assert((offset == std::vector<std::size_t>{ 0, 1, 4, 4, 6 }));
+    assert((descendants == std::vector<std::size_t>{ 5, 4, 6, 7, 1, 3 }));
+
+    // invalid node index
+    assert(a.getNumOfDescendants({ 1, 8 }, counts) == false);
+}
+
+void profileTest() {
+    // create tree
+    FlatTree<int> a({ 0, 1, 2, 3, 4, 5, 6, 7 },
+                    { 0, 0, 7, 0, 1, 3, 1, 1 });
+
+    const TreeProfile profile{ a.profile() };
+    assert((profile.child_count == std::vector<std::size_t>{ 2, 3, 0, 1, 0, 0, 0, 1 }));
+    assert((profile.fan_out     == std::vector<std::size_t>{ 4, 2, 1, 1 }));
+    assert((profile.width       == std::vector<std::size_t>{ 1, 2, 4, 1 }));
+    assert(profile.leaves == 4);
+    assert(profile.height == 3);
+
+    // a tree which only has a root
+    FlatTree<int> b(0);
+    assert(b.profile().leaves == 1);
+    assert(b.profile().height == 0);
+}
+
+void serializationTest() {
+    // create tree
+    FlatTree<int> a({ 0, 10, 20, 30, 40, 50, 60, 70 },
+                    { 0, 0,  0,  1,  1,  1,  2,  2 });
+    const std::string path{ "/tmp/flat_tree_test_" + std::to_string(::getpid()) + ".bin" };
+
+    // save/load
+    assert(FlatTreeIO::save(a, path) == true);
+    FlatTree<int> b(0);
+    assert(FlatTreeIO::load(path, b) == true);
+    assert(b.size() == 8);
+    assert(b[5] == 50);
+    assert(b.getParentIndex(7) == 2);
+
+    // snapshot while tree is modified
+    std::future<bool> written{ FlatTreeIO::snapshot(a, path) };
+    a << std::make_pair(7, 80);
+    a[1] = -10;
+    assert(written.get() == true);
+
+    FlatTree<int> c(0);
+    assert(FlatTreeIO::load(path, c) == true);
+    assert(c.size() == 8);
+    assert(c[1] == 10);
+
+    // load with overlapped reads (small chunks to exercise several reads in flight)
+    FlatTree<int> d(0);
+    assert(FlatTreeIO::loadOverlapped(path, d, 64, 2) == true);
+    assert(d.size() == 8);
+    assert(d[7] == 70);
+    assert(d.getParentIndex(6) == 2);
+
+    // overlapped load of a tree with non default allocators, with a chunk size larger than a single read allows
+    FlatTree<int, TaggedAllocator<int>, TaggedAllocator<std::size_t>> tagged(0, TaggedAllocator<int>(3), TaggedAllocator<std::size_t>(3));
+    assert(FlatTreeIO::loadOverlapped(path, tagged, std::size_t{ 1 } << 33) == true);
+    assert(tagged.size() == 8);
+    assert(tagged[7] == 70);
+    assert(tagged.dataAllocator().tag == 3);
+
+    // concurrent snapshots of the same file
+    std::future<bool> first{ FlatTreeIO::snapshot(a, path) },
+                      second{ FlatTreeIO::snapshot(a, path) };
+    assert(first.get() == true);
+    assert(second.get() == true);
+    assert(FlatTreeIO::load(path, c) == true);
+    assert(c.size() == 9);
+    assert(c[1] == -10);
+
+    // corrupt files are rejected (declared size does not match file length, parent out of range)
+    {
+        const int fd{ ::open(path.c_str(), O_WRONLY) };
+        const std::uint64_t huge{ std::uint64_t{ 1 } << 60 },
+                            nine{ 9 },
+                            outside{ 100 };
+        assert(::pwrite(fd, &huge, sizeof(huge), 16) == sizeof(huge));
+        assert(FlatTreeIO::load(path, c) == false);
+        assert(FlatTreeIO::loadOverlapped(path, c) == false);
+        assert(::pwrite(fd, &nine, sizeof(nine), 16) == sizeof(nine));
+        assert(::pwrite(fd, &outside, sizeof(outside), 64 + 3 * sizeof(std::uint64_t)) == sizeof(outside));
+        assert(FlatTreeIO::load(path, c) == false);
+        assert(FlatTreeIO::loadOverlapped(path, c) == false);
+        ::close(fd);
+        assert(c.size() == 9);
+    }
+
+    // block compressed file (three nodes per block)
+    assert(FlatTreeIO::saveCompressed(a, path, 3) == true);
+    FlatTree<int> e(0);
+    assert(FlatTreeIO::load(path, e) == true);
+    assert(e.size() == 9);
+    assert(e[1] == -10);
+    assert(e[8] == 80);
+    assert(e.getParentIndex(8) == 7);
+
+    // corrupt block compressed files are rejected before node collections are allocated
+    {
+        const int fd{ ::open(path.c_str(), O_WRONLY) };
+        const std::uint64_t huge{ std::uint64_t{ 1 } << 60 },
+                            nine{ 9 };
+        assert(::pwrite(fd, &huge, sizeof(huge), 16) == sizeof(huge));
+        assert(FlatTreeIO::load(path, e) == false);
+        assert(::pwrite(fd, &nine, sizeof(nine), 16) == sizeof(nine));
+        assert(::pwrite(fd, &huge, sizeof(huge), 24) == sizeof(huge));
+        assert(FlatTreeIO::load(path, e) == false);
+        ::close(fd);
+        assert(e.size() == 9);
+    }
+
+    // saving into a missing directory fails
+    const std::string missing{ "/tmp/flat_tree_missing_" + std::to_string(::getpid()) + "/tree.bin" };
+    assert(FlatTreeIO::saveCompressed(a, missing) == false);
+
+    ::unlink(path.c_str());
+}
+
+void arrowTest() {
+    // create tree
+    FlatTree<std::string> a({ "root", "child1", "child2", "", "grand child 1" },
+                            { 0,      0,        0,        1,  1 });
+    const std::string path{ "/tmp/flat_tree_test_" + std::to_string(::getpid()) + ".arrow" };
+
+    // export/import
+    assert(FlatTreeIO::saveArrow(a, path) == true);
+    FlatTree<std::string> b(std::string{});
+    assert(FlatTreeIO::loadArrow(path, b) == true);
+    assert(b.size() == 5);
+    assert(b[2] == "child2");
+    assert(b[3].empty());
+    assert(b.getParentIndex(4) == 1);
+
+    // value column type must match tree node type
+    FlatTree<double> c(0.0);
+    assert(FlatTreeIO::loadArrow(path, c) == false);
+    assert(c.size() == 1);
+
+    // stream with an additional (variable length) column preceding tree columns
+    {
+        using namespace FlatTreeArrowDetail;
+        FlatBufferBuilder schema_builder;
+        const std::size_t label_field{ makeField<std::string>(schema_builder, "label") },
+                          parent_field{ makeField<std::uint64_t>(schema_builder, "parent") },
+                          value_field{ makeField<int>(schema_builder, "value") },
+                          fields{ schema_builder.createOffsetVector({ label_field, parent_field, value_field }) };
+        schema_builder.startTable();
+        schema_builder.addOffset(1, fields);
+        const std::vector<std::uint8_t> schema{ makeMessage(schema_builder, header_schema, schema_builder.endTable(), 0) };
+
+        // body: {label validity, label offsets, label data, parent validity, parent data, value validity, value data}
+        const std::int32_t offsets[4]{ 0, 1, 2, 3 };
+        const std::uint64_t parents[3]{ 0, 0, 1 };
+        const int values[3]{ 5, 6, 7 };
+        std::vector<std::uint8_t> body(4 * body_alignment, 0);
+        std::memcpy(body.data(), offsets, sizeof(offsets));
+        std::memcpy(body.data() + body_alignment, "xyz", 3);
+        std::memcpy(body.data() + 2 * body_alignment, parents, sizeof(parents));
+        std::memcpy(body.data() + 3 * body_alignment, values, sizeof(values));
+        const std::vector<std::int64_t> buffers{ 0, 0, 0, sizeof(offsets), 64, 3, 128, 0, 128, sizeof(parents), 192, 0, 192, sizeof(values) };
+
+        FlatBufferBuilder batch_builder;
+        const std::size_t nodes{ batch_builder.createStructVector({ 3, 0, 3, 0, 3, 0 }, 2) },
+                          buffer_list{ batch_builder.createStructVector(buffers, 2) };
+        batch_builder.startTable();
+        batch_builder.addScalar<std::int64_t>(0, 3);
+        batch_builder.addOffset(1, nodes);
+        batch_builder.addOffset(2, buffer_list);
+        const std::vector<std::uint8_t> batch{ makeMessage(batch_builder, header_record_batch, batch_builder.endTable(), static_cast<std::int64_t>(body.size())) };
+
+        const int fd{ ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644) };
+        const std::uint32_t end_of_stream[2]{ continuation, 0 };
+        assert(writeMessage(fd, schema) && writeMessage(fd, batch) && FlatTreeIODetail::writeAll(fd, body.data(), body.size()) &&
+               FlatTreeIODetail::writeAll(fd, end_of_stream, sizeof(end_of_stream)));
+        ::close(fd);
+    }
+
+    // loaded into a tree with non default allocators
+    FlatTree<int, TaggedAllocator<int>, TaggedAllocator<std::size_t>> d(0, TaggedAllocator<int>(5), TaggedAllocator<std::size_t>(5));
+    assert(FlatTreeIO::loadArrow(path, d) == true);
+    assert(d.size() == 3);
+    assert(d[2] == 7);
+    assert(d.getParentIndex(2) == 1);
+    assert(d.dataAllocator().tag == 5);
+
+    ::unlink(path.c_str());
+}
+
+void externalTreeTest() {
+    // create tree (parent index smaller than node index)
+    FlatTree<int> a({ 0, 10, 20, 30, 40, 50, 60, 70 },
+                    { 0, 0,  0,  1,  1,  2,  4,  4 });
+    const std::string path{ "/tmp/flat_tree_test_" + std::to_string(::getpid()) + ".bin" },
+                      output{ path + ".out" };
+    assert(FlatTreeIO::save(a, path) == true);
+
+    const auto read = [&output](auto& xo_values) {
+        FILE* file{ ::fopen(output.c_str(), "rb") };
+        const std::size_t count{ ::fread(xo_values.data(), sizeof(xo_values[0]), xo_values.size(), file) };
+        ::fclose(file);
+        return count == xo_values.size();
+    };
+
+    // depth, sub-tree size, pre-order position and sub-tree sum (small memory budget, to exercise spilling)
+    std::vector<std::uint64_t> values(8);
+    assert(ExternalTree::computeDepth(path, output, 256) == true);
+    assert(read(values) == true);
+    assert((values == std::vector<std::uint64_t>{ 0, 1, 1, 2, 2, 2, 3, 3 }));
+
+    assert(ExternalTree::computeSubtreeSize(path, output, 256) == true);
+    assert(read(values) == true);
+    assert((values == std::vector<std::uint64_t>{ 8, 5, 2, 1, 3, 1, 1, 1 }));
+
+    assert(ExternalTree::computePreorder(path, output, 256) == true);
+    assert(read(values) == true);
+    assert((values == std::vector<std::uint64_t>{ 0, 1, 6, 2, 3, 7, 4, 5 }));
+
+    std::vector<long> sums(8);
+    assert((ExternalTree::reduceSubtrees<int, long>(path, output, [](const int& v) { return static_cast<long>(v); },
+                                                    [](long& xio_sum, const long xi_descendant) { xio_sum += xi_descendant; }, 256) == true));
+    assert(read(sums) == true);
+    assert((sums == std::vector<long>{ 280, 210, 70, 30, 170, 50, 60, 70 }));
+
+    // larger tree, compared against in memory depth
+    std::vector<int> data(5'000);
+    std::vector<std::size_t> parents(5'000);
+    for (std::size_t i{ 1 }; i < parents.size(); ++i) {
+        parents[i] = (i * 7919) % i;
+    }
+    FlatTree<int> b(std::move(data), std::move(parents));
+    assert(FlatTreeIO::save(b, path) == true);
+    values.resize(5'000);
+    assert(ExternalTree::computeDepth(path, output, 1'024) == true);
+    assert(read(values) == true);
+    for (std::size_t i{}; i < values.size(); ++i) {
+        assert(values[i] == b.getDepth(i));
+    }
+
+    // wide tree (root receives a message from every node, so queue spills many runs and merges them across levels)
+    std::vector<int> star_data(20'000);
+    std::vector<std::size_t> star_parents(20'000, 0);
+    FlatTree<int> star(std::move(star_data), std::move(star_parents));
+    assert(FlatTreeIO::save(star, path) == true);
+    values.resize(20'000);
+    assert(ExternalTree::computeSubtreeSize(path, output, 1'024) == true);
+    assert(read(values) == true);
+    assert(values[0] == 20'000);
+    assert(std::all_of(values.begin() + 1, values.end(), [](const std::uint64_t size) { return size == 1; }));
+
+    // tree must be topologically ordered
+    FlatTree<int> c({ 0, 1, 2 },
+                    { 0, 2, 0 });
+    assert(FlatTreeIO::save(c, path) == true);
+    assert(ExternalTree::computeDepth(path, output) == false);
+
+    ::unlink(path.c_str());
+    ::unlink(output.c_str());
+}
+
 int main() {
     constructionTest();
     modifyTreeTest();
     traverseTreeTest();
+    sortChildrenTest();
+    distanceTest();
+    centroidIndexTest();
+    virtualTreeTest();
+    treeColumnTest();
+    filterTest();
+    pathEnumerationTest();
+    ancestorTest();
+    subtreeUpdateTest();
+    sharedTreeTest();
+    joinTest();
+    attributeTest();
+    bestFirstTest();
+    reorderTest();
+    heatRelayoutTest();
+    splitTreeTest();
+    mappedTreeTest();
+    traversalBufferTest();
+    batchQueryTest();
+    profileTest();
+    serializationTest();
+    arrowTest();
+    externalTreeTest();
     return 1;
 }